@@ -0,0 +1,85 @@
+#include "scratch_image.hpp"
+#include <benchmark/benchmark.h>
+#include <sstream>
+
+namespace {
+
+// range(0) directories with range(1) files of 4 KiB each
+auto make_tree(FileSystem &file_system, std::int64_t dirs_count, std::int64_t files_count) -> void {
+  std::stringstream data(std::string(4096, 'x'));
+  file_system.mkdir("tree");
+  for (std::int64_t dir = 0; dir < dirs_count; ++dir) {
+    auto dir_path = "tree/dir" + std::to_string(dir);
+    file_system.mkdir(dir_path);
+    for (std::int64_t file = 0; file < files_count; ++file) {
+      file_system.import_file(data, dir_path + "/file" + std::to_string(file));
+    }
+  }
+  file_system.sync();
+}
+
+} // namespace
+
+static void BM_CopyRecursive(benchmark::State &state) {
+  ScratchImage image("bench_cp.fs", {64 * 1024 * 1024, 4096});
+  auto file_system = image.open();
+  make_tree(file_system, state.range(0), state.range(1));
+
+  for (auto _ : state) {
+    file_system.cp("tree", "copy", true);
+    file_system.sync();
+
+    state.PauseTiming();
+    file_system.rm("copy", true);
+    file_system.sync();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_CopyRecursive)->Args({4, 16})->Args({16, 16});
+
+// 200 files of 256 KiB copied on range(0) threads
+static void BM_CopyRecursiveParallel(benchmark::State &state) {
+  std::int64_t const files_count = 200;
+  std::int64_t const file_size = 256 * 1024;
+  ScratchImage image("bench_cp_parallel.fs", {256 * 1024 * 1024, 4096});
+  auto file_system = image.open();
+  std::string const data(file_size, 'x');
+  file_system.mkdir("tree");
+  for (std::int64_t file = 0; file < files_count; ++file) {
+    std::stringstream in_stream(data);
+    file_system.import_file(in_stream, "tree/file" + std::to_string(file));
+  }
+  file_system.sync();
+
+  auto threads = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    file_system.cp("tree", "copy", true, false, threads);
+    file_system.sync();
+
+    state.PauseTiming();
+    file_system.rm("copy", true);
+    file_system.sync();
+    state.ResumeTiming();
+  }
+  state.SetBytesProcessed(state.iterations() * files_count * file_size);
+}
+BENCHMARK(BM_CopyRecursiveParallel)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+static void BM_RemoveRecursive(benchmark::State &state) {
+  ScratchImage image("bench_rm.fs", {64 * 1024 * 1024, 4096});
+  auto file_system = image.open();
+  make_tree(file_system, state.range(0), state.range(1));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    file_system.cp("tree", "copy", true);
+    file_system.sync();
+    state.ResumeTiming();
+
+    file_system.rm("copy", true);
+    file_system.sync();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_RemoveRecursive)->Args({4, 16})->Args({16, 16});
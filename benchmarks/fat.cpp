@@ -0,0 +1,25 @@
+#include "scratch_image.hpp"
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <memory>
+
+// allocate and free one cluster with the table filled to range(0) percent
+static void BM_FATAllocate(benchmark::State &state) {
+  FSMaker::Settings const settings{16 * 1024 * 1024, 4096};
+  ScratchImage image("bench_fat.fs", settings);
+
+  auto ifs = std::make_unique<std::ifstream>(image.get_path(), std::ios::binary | std::ios::in);
+  auto ofs = std::make_unique<std::ofstream>(image.get_path(), std::ios::binary | std::ios::out | std::ios::in);
+  FAT fat(DiskReader(std::move(ifs), 0, 0), DiskWriter(std::move(ofs), 0), FSMaker::get_fat_offset(),
+          FSMaker::calculate_fat_entries_count(settings));
+
+  auto filled = fat.get_clusters_count() * static_cast<std::uint64_t>(state.range(0)) / 100;
+  if (filled > 0) static_cast<void>(fat.allocate_chain(filled));
+
+  for (auto _ : state) {
+    auto cluster = fat.allocate();
+    fat.free(cluster);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FATAllocate)->Arg(0)->Arg(50)->Arg(95);
@@ -0,0 +1,54 @@
+#include "scratch_image.hpp"
+#include <benchmark/benchmark.h>
+#include <sstream>
+
+namespace {
+
+auto make_stream(std::int64_t size) -> std::stringstream {
+  std::string data(static_cast<std::size_t>(size), '\0');
+  for (std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<char>('a' + i % 26);
+  return std::stringstream(data);
+}
+
+auto sizes(benchmark::internal::Benchmark *benchmark) -> void {
+  for (std::int64_t cluster_size : {512, 4096}) {
+    for (std::int64_t file_size : {4 << 10, 64 << 10, 1 << 20}) benchmark->Args({file_size, cluster_size});
+  }
+}
+
+} // namespace
+
+// range(0) is the file size, range(1) the cluster size; every import is synced to the image
+static void BM_Import(benchmark::State &state) {
+  ScratchImage image("bench_import.fs", {64 * 1024 * 1024, static_cast<std::uint64_t>(state.range(1))});
+  auto file_system = image.open();
+  auto stream = make_stream(state.range(0));
+
+  for (auto _ : state) {
+    file_system.import_file(stream, "file");
+    file_system.sync();
+
+    state.PauseTiming();
+    file_system.rm("file");
+    file_system.sync();
+    state.ResumeTiming();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Import)->Apply(sizes);
+
+static void BM_Export(benchmark::State &state) {
+  ScratchImage image("bench_export.fs", {64 * 1024 * 1024, static_cast<std::uint64_t>(state.range(1))});
+  auto file_system = image.open();
+  auto stream = make_stream(state.range(0));
+  file_system.import_file(stream, "file");
+  file_system.sync();
+
+  for (auto _ : state) {
+    std::ostringstream out;
+    file_system.export_file("file", out);
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Export)->Apply(sizes);
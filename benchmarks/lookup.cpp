@@ -0,0 +1,49 @@
+#include "scratch_image.hpp"
+#include <benchmark/benchmark.h>
+
+// stat a file nested range(0) directories deep
+static void BM_LookupDepth(benchmark::State &state) {
+  ScratchImage image("bench_lookup.fs", {16 * 1024 * 1024, 512});
+  auto file_system = image.open();
+
+  std::string path;
+  for (std::int64_t i = 0; i < state.range(0); ++i) {
+    path += "/dir";
+    file_system.mkdir(path);
+  }
+  path += "/file";
+  file_system.touch(path);
+
+  for (auto _ : state) benchmark::DoNotOptimize(file_system.stat(path));
+}
+BENCHMARK(BM_LookupDepth)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
+namespace {
+
+auto fill_dir(FileSystem &file_system, std::int64_t count) -> void {
+  file_system.mkdir("dir");
+  for (std::int64_t i = 0; i < count; ++i) file_system.touch("dir/file" + std::to_string(i));
+}
+
+} // namespace
+
+// stat the last entry of a directory with range(0) entries
+static void BM_LookupFanout(benchmark::State &state) {
+  ScratchImage image("bench_fanout.fs", {16 * 1024 * 1024, 512});
+  auto file_system = image.open();
+  fill_dir(file_system, state.range(0));
+
+  auto path = "dir/file" + std::to_string(state.range(0) - 1);
+  for (auto _ : state) benchmark::DoNotOptimize(file_system.stat(path));
+}
+BENCHMARK(BM_LookupFanout)->Arg(16)->Arg(256)->Arg(1024);
+
+static void BM_Ls(benchmark::State &state) {
+  ScratchImage image("bench_ls.fs", {16 * 1024 * 1024, 512});
+  auto file_system = image.open();
+  fill_dir(file_system, state.range(0));
+
+  for (auto _ : state) benchmark::DoNotOptimize(file_system.ls("dir"));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Ls)->Arg(16)->Arg(256)->Arg(1024);
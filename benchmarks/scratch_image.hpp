@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../src/FileSystem/FileSystem.hpp"
+#include <filesystem>
+#include <string>
+
+// a fresh image for one benchmark run, removed when the run ends
+class ScratchImage {
+  std::string path_;
+
+public:
+  ScratchImage(std::string path, FSMaker::Settings const &settings) : path_(std::move(path)) {
+    FileSystem::make(path_, settings);
+  }
+  ScratchImage(const ScratchImage &) = delete;
+  ScratchImage(ScratchImage &&) = delete;
+
+  ~ScratchImage() { std::filesystem::remove(path_); }
+  auto operator=(const ScratchImage &) -> ScratchImage & = delete;
+  auto operator=(ScratchImage &&) -> ScratchImage & = delete;
+
+  [[nodiscard]] auto get_path() const noexcept -> std::string const & { return path_; }
+  [[nodiscard]] auto open() const -> FileSystem { return FileSystem(path_); }
+};
@@ -1,6 +1,11 @@
 #include "CLI.hpp"
 
-CLI::CLI() {
+CLI::CLI(std::string const &image_path) : owns_image_(image_path.empty()) {
+  if (!owns_image_) {
+    file_system_ = FileSystem(image_path);
+    return;
+  }
+
   const auto SIZE = static_cast<std::uint64_t>(64 * 1024 * 1024); // 64 MB
   const std::uint64_t CLUSTER_SIZE = 256;
 
@@ -8,7 +13,13 @@ CLI::CLI() {
   file_system_ = FileSystem("cli.fs");
 }
 
-CLI::~CLI() { std::filesystem::remove("cli.fs"); }
+CLI::~CLI() {
+  // nothing may be written back into the image once it is gone
+  try {
+    file_system_.drain();
+  } catch (...) {} // NOLINT(bugprone-empty-catch) the image is removed anyway
+  if (owns_image_) std::filesystem::remove("cli.fs");
+}
 
 auto CLI::run() -> void {
   std::cout << "Welcome to the File System!\n";
@@ -16,30 +27,87 @@ auto CLI::run() -> void {
 
   std::string user_input;
   while (true) {
-    std::cout << prompt();
+    std::string prompt_text;
+    {
+      LatencyHistogram::Timer timer(prompt_latency_);
+      prompt_text = prompt();
+    }
+    std::cout << prompt_text;
 
-    std::getline(std::cin, user_input);
+    if (!std::getline(std::cin, user_input)) break;
 
-    std::istringstream iss(user_input);
+    auto [command, args] = parse(user_input);
+    if (command == "exit") { break; }
 
-    std::string command;
-    iss >> command;
+    static_cast<void>(run_command(command, args));
+  }
+}
 
-    std::vector<std::string> args;
-    std::string arg;
-    while (iss >> arg) { args.push_back(arg); }
+auto CLI::run_batch(std::istream &in_stream) -> bool {
+  // no prompt between commands and a single sync at the end; the writeback thread still flushes while the script runs
+  auto start = std::chrono::steady_clock::now();
+  std::uint64_t commands_count = 0;
+  std::uint64_t failures_count = 0;
 
-    if (command == "exit") { break; }
+  std::string line;
+  while (std::getline(in_stream, line)) {
+    auto [command, args] = parse(line);
+    if (command.empty() || command[0] == '#') continue;
+    if (command == "exit") break;
 
-    try {
-      execute(command, args);
-    } catch (std::exception const &e) { std::cout << e.what() << '\n'; }
+    ++commands_count;
+    if (!run_command(command, args)) ++failures_count;
   }
+  file_system_.sync();
+
+  auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+  std::cout << "Ran " << commands_count << " commands (" << failures_count << " failed) in " << std::fixed
+            << std::setprecision(1) << elapsed.count() << " ms\n";
+  return failures_count == 0;
+}
+
+auto CLI::parse(std::string const &line) -> std::pair<std::string, std::vector<std::string>> {
+  std::istringstream iss(line);
+
+  std::string command;
+  iss >> command;
+
+  std::vector<std::string> args;
+  std::string arg;
+  while (iss >> arg) { args.push_back(arg); }
+
+  return {command, args};
+}
+
+auto CLI::parse_number(std::string const &value, std::string const &usage, std::uint64_t minimum) -> std::uint64_t {
+  auto number = Workload::parse_number(value);
+  if (!number.has_value() || number.value() < minimum) throw std::invalid_argument("Wrong arguments. Usage: " + usage);
+  return number.value();
+}
+
+auto CLI::run_command(std::string const &command, std::vector<std::string> const &args) -> bool {
+  auto start = std::chrono::steady_clock::now();
+  auto known = true;
+  auto failed = false;
+  try {
+    known = execute(command, args);
+  } catch (std::exception const &e) {
+    std::cout << e.what() << '\n';
+    failed = true;
+  }
+  auto latency = std::chrono::steady_clock::now() - start;
+  if (known) command_latencies_[command].record(latency);
+
+  if (trace_.is_open() && Workload::is_replayable(command)) {
+    auto offset = std::chrono::duration_cast<std::chrono::microseconds>(start - trace_start_);
+    Workload::write(trace_, {offset, latency, command, args});
+  }
+  return known && !failed;
 }
 
 auto CLI::prompt() -> std::string { return file_system_.pwd() + " $ "; }
 
-auto CLI::execute(std::string const &command, std::vector<std::string> args) -> void {
+auto CLI::execute(std::string const &command, std::vector<std::string> args) -> bool {
   if (command == "help") {
     help();
   } else if (command == "clear") {
@@ -50,6 +118,12 @@ auto CLI::execute(std::string const &command, std::vector<std::string> args) ->
     openfs(std::move(args));
   } else if (command == "fsinfo") {
     fsinfo();
+  } else if (command == "stats") {
+    stats(std::move(args));
+  } else if (command == "record") {
+    record(std::move(args));
+  } else if (command == "replay") {
+    replay(std::move(args));
   } else if (command == "dirname") {
     dirname(std::move(args));
   } else if (command == "basename") {
@@ -58,10 +132,16 @@ auto CLI::execute(std::string const &command, std::vector<std::string> args) ->
     pwd();
   } else if (command == "cat") {
     cat(std::move(args));
+  } else if (command == "head") {
+    head(std::move(args));
+  } else if (command == "tail") {
+    tail(std::move(args));
   } else if (command == "ls") {
     ls(std::move(args));
   } else if (command == "stat") {
     stat(std::move(args));
+  } else if (command == "du") {
+    du(std::move(args));
   } else if (command == "mkdir") {
     mkdir(std::move(args));
   } else if (command == "cd") {
@@ -82,7 +162,9 @@ auto CLI::execute(std::string const &command, std::vector<std::string> args) ->
     export_file(std::move(args));
   } else {
     std::cout << "Unknown command. Type 'help' to see available commands.\n";
+    return false;
   }
+  return true;
 }
 
 auto CLI::help() -> void {
@@ -94,22 +176,35 @@ auto CLI::help() -> void {
   std::cout << "-\t'makefs <path> <size> <cluster_size>' - create a new file system\n";
   std::cout << "-\t'openfs <path>' - open an existing file system\n";
   std::cout << "-\t'fsinfo' - show file system info\n";
+  std::cout << "-\t'stats [reset | dump <host_path>]' - show command latencies, reset them or dump the histograms "
+               "as csv\n";
+  std::cout << "-\t'record <host_path> | record stop' - start or stop recording file system commands into a trace\n";
+  std::cout << "-\t'replay <host_path> [-j <threads>]' - replay a trace against a fresh image and report throughput "
+               "and latencies, -j replays it in every thread\n";
   std::cout << '\n';
   std::cout << "-\t'dirname <path>' - get the directory portion of a pathname\n";
   std::cout << "-\t'basename <path>' - get the filename portion of a pathname\n";
   std::cout << "-\t'pwd' - print current working directory\n";
   std::cout << "-\t'ls [-l]' - list directory contents\n";
   std::cout << "-\t'stat <path>' - print file metadata\n";
-  std::cout << "-\t'cat <path>' - print file contents\n";
+  std::cout << "-\t'du <path>' - summarize the size and disk usage of a file or directory tree\n";
+  std::cout << "-\t'cat [--offset <bytes>] [--length <bytes>] <path>' - print file contents, or only the given byte "
+               "range\n";
+  std::cout << "-\t'head -c <bytes> <path>' - print the first bytes of a file\n";
+  std::cout << "-\t'tail -c <bytes> <path>' - print the last bytes of a file\n";
   std::cout << "-\t'mkdir <path>' - create a directory\n";
   std::cout << "-\t'cd <path>' - change the working directory\n";
   std::cout << "-\t'touch <path>' - create a file\n";
   std::cout << "-\t'rmdir <path>' - remove a directory\n";
   std::cout << "-\t'rm [-r] <path>' - remove directory entries\n";
-  std::cout << "-\t'cp [-r] <source> <destination>' - copy files and directories\n";
+  std::cout << "-\t'cp [-r] [--reflink] [-j <threads>] <source> <destination>' - copy files and directories, "
+               "--reflink shares the data clusters until they are written, -j copies file data of -r in parallel\n";
   std::cout << "-\t'mv [-r] <source> <destination>' - move files and directories\n";
-  std::cout << "-\t'import <host_path> <fs_path>' - import a file from the host file system\n";
-  std::cout << "-\t'export <fs_path> <host_path>' - export a file to the host file system\n";
+  std::cout << "-\t'import [-r] [-j <threads>] [--tar] <host_path> <fs_path>' - import a file from the host file "
+               "system, -r imports a directory tree reading files with -j threads, --tar unpacks a tar archive\n";
+  std::cout << "-\t'export [-r] [-j <threads>] [--tar] <fs_path> <host_path>' - export a file to the host file "
+               "system, -r exports a directory tree writing files with -j threads, --tar packs a directory into a tar "
+               "archive\n";
 }
 
 auto CLI::clear() -> void {
@@ -117,14 +212,13 @@ auto CLI::clear() -> void {
   std::system("cls");
 #else
   // Assume POSIX
-  if (std::system("clear") != 0) { std::cout << "Error while clearing the screen\n"; }
+  if (std::system("clear") != 0) throw std::runtime_error("Error while clearing the screen");
 #endif
 }
 
 auto CLI::makefs(std::vector<std::string> args) -> void {
   if (args.size() != 3) {
-    std::cout << "Wrong number of arguments. Usage: makefs <path> <size> <cluster_size>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: makefs <path> <size> <cluster_size>");
   }
 
   std::string path = args[0];
@@ -136,8 +230,7 @@ auto CLI::makefs(std::vector<std::string> args) -> void {
 
 auto CLI::openfs(std::vector<std::string> args) -> void {
   if (args.size() != 1) {
-    std::cout << "Wrong number of arguments. Usage: openfs <path>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: openfs <path>");
   }
 
   file_system_ = FileSystem(args[0]);
@@ -145,19 +238,104 @@ auto CLI::openfs(std::vector<std::string> args) -> void {
 
 auto CLI::fsinfo() -> void { std::cout << file_system_ << '\n'; }
 
-auto CLI::dirname(std::vector<std::string> args) -> void {
+auto CLI::stats(std::vector<std::string> args) -> void {
+  auto const &phases = file_system_.get_phase_latencies();
+  std::vector<std::pair<std::string, LatencyHistogram const *>> histograms;
+  for (auto const &[command, histogram] : command_latencies_) histograms.emplace_back(command, &histogram);
+  histograms.emplace_back("<prompt>", &prompt_latency_);
+  histograms.emplace_back("<resolve>", &phases.resolve);
+  histograms.emplace_back("<metadata>", &phases.metadata);
+  histograms.emplace_back("<data>", &phases.data);
+
+  if (args.empty()) {
+    for (auto const &[name, histogram] : histograms) {
+      if (histogram->get_count() == 0) continue;
+      std::cout << name << ": " << LatencyHistogram::to_string(histogram->summary()) << '\n';
+    }
+  } else if (args.size() == 1 && args[0] == "reset") {
+    command_latencies_.clear();
+    prompt_latency_.reset();
+    file_system_.reset_phase_latencies();
+  } else if (args.size() == 2 && args[0] == "dump") {
+    std::ofstream out_stream(args[1]);
+    if (!out_stream.is_open()) {
+      throw std::runtime_error("Error while opening the file");
+    }
+    out_stream << "name,lower_ns,upper_ns,count\n";
+    for (auto const &[name, histogram] : histograms) histogram->dump(name, out_stream);
+  } else {
+    throw std::invalid_argument("Wrong arguments. Usage: stats [reset | dump <host_path>]");
+  }
+}
+
+auto CLI::record(std::vector<std::string> args) -> void {
   if (args.size() != 1) {
-    std::cout << "Wrong number of arguments. Usage: dirname <path>\n";
+    throw std::invalid_argument("Wrong number of arguments. Usage: record <host_path> | record stop");
+  }
+
+  if (args[0] == "stop") {
+    if (!trace_.is_open()) {
+      throw std::invalid_argument("Not recording");
+    }
+    trace_.close();
     return;
   }
 
+  if (trace_.is_open()) trace_.close();
+  trace_.open(args[0]);
+  if (!trace_.is_open()) {
+    throw std::runtime_error("Error while opening the file");
+  }
+  trace_ << "# start_us duration_ns command args...\n";
+  trace_start_ = std::chrono::steady_clock::now();
+}
+
+auto CLI::replay(std::vector<std::string> args) -> void {
+  std::string const usage = "replay <host_path> [-j <threads>]";
+  std::size_t threads = 1;
+  if (args.size() == 3 && args[1] == "-j") {
+    threads = parse_number(args[2], usage, 1);
+  } else if (args.size() != 1) {
+    throw std::invalid_argument("Wrong number of arguments. Usage: " + usage);
+  }
+
+  std::ifstream in_stream(args[0]);
+  if (!in_stream.is_open()) {
+    throw std::runtime_error("Error while opening the file");
+  }
+  auto operations = Workload::read(in_stream);
+
+  // the trace runs on an empty image of the same geometry in the temporary directory, the current one is left alone
+  auto path = std::filesystem::temp_directory_path() / ("replay-" + std::to_string(std::random_device()()) + ".fs");
+  while (std::filesystem::exists(path)) {
+    path.replace_filename("replay-" + std::to_string(std::random_device()()) + ".fs");
+  }
+  FileSystem::make(path.string(), file_system_.get_settings());
+  Workload::Report report;
+  try {
+    FileSystem replayer(path.string());
+    Workload::replay(replayer, operations, report, threads);
+    replayer.drain();
+  } catch (...) {
+    std::filesystem::remove(path);
+    throw;
+  }
+  std::filesystem::remove(path);
+
+  std::cout << Workload::to_string(report);
+}
+
+auto CLI::dirname(std::vector<std::string> args) -> void {
+  if (args.size() != 1) {
+    throw std::invalid_argument("Wrong number of arguments. Usage: dirname <path>");
+  }
+
   std::cout << file_system_.dirname(args[0]) << '\n';
 }
 
 auto CLI::basename(std::vector<std::string> args) -> void {
   if (args.size() != 1) {
-    std::cout << "Wrong number of arguments. Usage: basename <path>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: basename <path>");
   }
 
   std::cout << file_system_.basename(args[0]) << '\n';
@@ -169,7 +347,6 @@ auto CLI::ls(std::vector<std::string> args) -> void {
   bool verbose = false;
 
   std::string path;
-  std::vector<Metadata> files;
 
   if (args.empty()) {
     path = ".";
@@ -185,43 +362,92 @@ auto CLI::ls(std::vector<std::string> args) -> void {
       verbose = true;
       path = args[0];
     } else {
-      std::cout << "Wrong arguments. Usage: ls [-l] <path>\n";
-      return;
+      throw std::invalid_argument("Wrong arguments. Usage: ls [-l] <path>");
     }
   } else {
-    std::cout << "Wrong number of arguments. Usage: ls [-l] <path>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: ls [-l] <path>");
   }
 
-  files = file_system_.ls(path);
+  // entries are printed chunk by chunk as the cursor reads them, only -l needs more than names
+  auto cursor = file_system_.readdir(path, !verbose);
 
   std::cout << file_system_.basename(path) << "\n";
-  for (auto const &file : files) { std::cout << "|----" << Metadata::to_string(file, verbose) << '\n'; }
+  for (auto entries = cursor.next(); !entries.empty(); entries = cursor.next()) {
+    for (auto const &entry : entries) {
+      if (verbose) {
+        std::cout << "|----" << Metadata::to_string(entry.metadata.value(), true) << '\n';
+      } else {
+        std::cout << "|----" << (entry.is_directory ? "D " : "F ") << entry.name << '\n';
+      }
+    }
+    std::cout << std::flush;
+  }
 }
 
 auto CLI::stat(std::vector<std::string> args) -> void {
   if (args.size() != 1) {
-    std::cout << "Wrong number of arguments. Usage: stat <path>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: stat <path>");
   }
 
   std::cout << Metadata::to_string(file_system_.stat(args[0]), true) << '\n';
 }
 
-auto CLI::cat(std::vector<std::string> args) -> void {
+auto CLI::du(std::vector<std::string> args) -> void {
   if (args.size() != 1) {
-    std::cout << "Wrong number of arguments. Usage: cat <path>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: du <path>");
+  }
+
+  auto usage = file_system_.du(args[0]);
+  std::cout << usage.size << " bytes in " << usage.files_count << " files and " << usage.dirs_count
+            << " directories, " << usage.clusters_count * file_system_.get_settings().cluster_size
+            << " bytes on disk in " << usage.clusters_count << " clusters\n";
+}
+
+auto CLI::cat(std::vector<std::string> args) -> void {
+  std::string const usage = "cat [--offset <bytes>] [--length <bytes>] <path>";
+  std::uint64_t offset = 0;
+  std::uint64_t length = std::numeric_limits<std::uint64_t>::max();
+  std::vector<std::string> paths;
+
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    if (args[i] == "--offset" && i + 1 < args.size()) {
+      offset = parse_number(args[++i], usage);
+    } else if (args[i] == "--length" && i + 1 < args.size()) {
+      length = parse_number(args[++i], usage);
+    } else {
+      paths.push_back(args[i]);
+    }
+  }
+
+  if (paths.size() != 1) {
+    throw std::invalid_argument("Wrong number of arguments. Usage: " + usage);
   }
 
-  file_system_.cat(args[0], std::cout);
+  file_system_.cat(paths[0], std::cout, offset, length);
+  std::cout << '\n';
+}
+
+auto CLI::head(std::vector<std::string> args) -> void {
+  if (args.size() != 3 || args[0] != "-c") {
+    throw std::invalid_argument("Wrong number of arguments. Usage: head -c <bytes> <path>");
+  }
+
+  file_system_.cat(args[2], std::cout, 0, parse_number(args[1], "head -c <bytes> <path>"));
+  std::cout << '\n';
+}
+
+auto CLI::tail(std::vector<std::string> args) -> void {
+  if (args.size() != 3 || args[0] != "-c") {
+    throw std::invalid_argument("Wrong number of arguments. Usage: tail -c <bytes> <path>");
+  }
+
+  file_system_.tail(args[2], std::cout, parse_number(args[1], "tail -c <bytes> <path>"));
   std::cout << '\n';
 }
 
 auto CLI::mkdir(std::vector<std::string> args) -> void {
   if (args.size() != 1) {
-    std::cout << "Wrong number of arguments. Usage: mkdir <path>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: mkdir <path>");
   }
 
   file_system_.mkdir(args[0]);
@@ -229,8 +455,7 @@ auto CLI::mkdir(std::vector<std::string> args) -> void {
 
 auto CLI::cd(std::vector<std::string> args) -> void {
   if (args.size() != 1) {
-    std::cout << "Wrong number of arguments. Usage: cd <path>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: cd <path>");
   }
 
   file_system_.cd(args[0]);
@@ -238,8 +463,7 @@ auto CLI::cd(std::vector<std::string> args) -> void {
 
 auto CLI::touch(std::vector<std::string> args) -> void {
   if (args.size() != 1) {
-    std::cout << "Wrong number of arguments. Usage: touch <path>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: touch <path>");
   }
 
   file_system_.touch(args[0]);
@@ -247,8 +471,7 @@ auto CLI::touch(std::vector<std::string> args) -> void {
 
 auto CLI::rmdir(std::vector<std::string> args) -> void {
   if (args.size() != 1) {
-    std::cout << "Wrong number of arguments. Usage: rmdir <path>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: rmdir <path>");
   }
 
   file_system_.rmdir(args[0]);
@@ -256,8 +479,7 @@ auto CLI::rmdir(std::vector<std::string> args) -> void {
 
 auto CLI::rm(std::vector<std::string> args) -> void {
   if (args.size() != 1 && args.size() != 2) {
-    std::cout << "Wrong number of arguments. Usage: rm [-r] <path>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: rm [-r] <path>");
   }
 
   bool recursive = false;
@@ -270,8 +492,7 @@ auto CLI::rm(std::vector<std::string> args) -> void {
       recursive = true;
       path = args[1];
     } else {
-      std::cout << "Wrong arguments. Usage: rm [-r] <path>\n";
-      return;
+      throw std::invalid_argument("Wrong arguments. Usage: rm [-r] <path>");
     }
   }
 
@@ -279,36 +500,34 @@ auto CLI::rm(std::vector<std::string> args) -> void {
 }
 
 auto CLI::cp(std::vector<std::string> args) -> void {
-  if (args.size() != 2 && args.size() != 3) {
-    std::cout << "Wrong number of arguments. Usage: cp [-r] <source> <destination>\n";
-    return;
-  }
-
+  std::string const usage = "cp [-r] [--reflink] [-j <threads>] <source> <destination>";
   bool recursive = false;
-  std::string source;
-  std::string destination;
+  bool reflink = false;
+  std::size_t threads = 1;
+  std::vector<std::string> paths;
 
-  if (args.size() == 2) {
-    source = args[0];
-    destination = args[1];
-  } else if (args.size() == 3) {
-    if (args[0] == "-r") {
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    if (args[i] == "-r") {
       recursive = true;
-      source = args[1];
-      destination = args[2];
+    } else if (args[i] == "--reflink") {
+      reflink = true;
+    } else if (args[i] == "-j" && i + 1 < args.size()) {
+      threads = parse_number(args[++i], usage, 1);
     } else {
-      std::cout << "Wrong arguments. Usage: cp [-r] <source> <destination>\n";
-      return;
+      paths.push_back(args[i]);
     }
   }
 
-  file_system_.cp(source, destination, recursive);
+  if (paths.size() != 2) {
+    throw std::invalid_argument("Wrong number of arguments. Usage: " + usage);
+  }
+
+  file_system_.cp(paths[0], paths[1], recursive, reflink, threads);
 }
 
 auto CLI::mv(std::vector<std::string> args) -> void {
   if (args.size() != 2 && args.size() != 3) {
-    std::cout << "Wrong number of arguments. Usage: mv [-r] <source> <destination>\n";
-    return;
+    throw std::invalid_argument("Wrong number of arguments. Usage: mv [-r] <source> <destination>");
   }
 
   bool recursive = false;
@@ -324,8 +543,7 @@ auto CLI::mv(std::vector<std::string> args) -> void {
       source = args[1];
       destination = args[2];
     } else {
-      std::cout << "Wrong arguments. Usage: mv [-r] <source> <destination>\n";
-      return;
+      throw std::invalid_argument("Wrong arguments. Usage: mv [-r] <source> <destination>");
     }
   }
 
@@ -333,39 +551,91 @@ auto CLI::mv(std::vector<std::string> args) -> void {
 }
 
 auto CLI::import_file(std::vector<std::string> args) -> void {
-  if (args.size() != 2) {
-    std::cout << "Wrong number of arguments. Usage: import <host_path> <fs_path>\n";
+  std::string const usage = "import [-r] [-j <threads>] [--tar] <host_path> <fs_path>";
+  bool recursive = false;
+  bool tar = false;
+  std::size_t threads = std::max(1U, std::thread::hardware_concurrency());
+  std::vector<std::string> paths;
+
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    if (args[i] == "-r") {
+      recursive = true;
+    } else if (args[i] == "--tar") {
+      tar = true;
+    } else if (args[i] == "-j" && i + 1 < args.size()) {
+      threads = parse_number(args[++i], usage, 1);
+    } else {
+      paths.push_back(args[i]);
+    }
+  }
+
+  if (paths.size() != 2) {
+    throw std::invalid_argument("Wrong number of arguments. Usage: " + usage);
+  }
+
+  if (recursive) {
+    file_system_.import_dir(paths[0], paths[1], threads);
     return;
   }
 
-  std::ifstream in_stream(args[0], std::ios::binary);
-  if (!in_stream.is_open()) {
-    std::cout << "Error while opening the file\n";
+  if (!tar) {
+    file_system_.import_from_host(paths[0], paths[1]);
     return;
   }
 
-  file_system_.import_file(in_stream, args[1]);
+  std::ifstream in_stream(paths[0], std::ios::binary);
+  if (!in_stream.is_open()) {
+    throw std::runtime_error("Error while opening the file");
+  }
+
+  file_system_.import_tar(in_stream, paths[1]);
   in_stream.close();
 }
 
 auto CLI::export_file(std::vector<std::string> args) -> void {
-  if (args.size() != 2) {
-    std::cout << "Wrong number of arguments. Usage: export <fs_path> <host_path>\n";
+  std::string const usage = "export [-r] [-j <threads>] [--tar] <fs_path> <host_path>";
+  bool recursive = false;
+  bool tar = false;
+  std::size_t threads = std::max(1U, std::thread::hardware_concurrency());
+  std::vector<std::string> paths;
+
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    if (args[i] == "-r") {
+      recursive = true;
+    } else if (args[i] == "--tar") {
+      tar = true;
+    } else if (args[i] == "-j" && i + 1 < args.size()) {
+      threads = parse_number(args[++i], usage, 1);
+    } else {
+      paths.push_back(args[i]);
+    }
+  }
+
+  if (paths.size() != 2) {
+    throw std::invalid_argument("Wrong number of arguments. Usage: " + usage);
+  }
+
+  if (recursive) {
+    file_system_.export_dir(paths[0], paths[1], threads);
     return;
   }
 
-  std::ofstream out_stream(args[1], std::ios::binary);
-  if (!out_stream.is_open()) {
-    std::cout << "Error while opening the file\n";
+  if (!tar) {
+    file_system_.export_to_host(paths[0], paths[1]);
     return;
   }
 
+  std::ofstream out_stream(paths[1], std::ios::binary);
+  if (!out_stream.is_open()) {
+    throw std::runtime_error("Error while opening the file");
+  }
+
   try {
-    file_system_.export_file(args[0], out_stream);
+    file_system_.export_tar(paths[0], out_stream);
     out_stream.close();
   } catch (const std::exception &e) {
     out_stream.close();
-    std::remove(args[1].c_str());
+    std::remove(paths[1].c_str());
     throw;
   }
 }
@@ -1,18 +1,30 @@
 #pragma once
 
 #include "../FileSystem/FileSystem.hpp"
+#include "Workload/Workload.hpp"
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <random>
 #include <string>
 #include <utility>
 
 class CLI {
   FileSystem file_system_;
+  bool owns_image_; // the scratch cli.fs is formatted on start and removed on exit, an opened image is kept
+
+  std::map<std::string, LatencyHistogram> command_latencies_;
+  LatencyHistogram prompt_latency_;
+
+  std::ofstream trace_;
+  std::chrono::steady_clock::time_point trace_start_;
 
 public:
-  CLI();
+  explicit CLI(std::string const &image_path = "");
   CLI(CLI const &) = delete;
   CLI(CLI &&) = delete;
 
@@ -22,10 +34,17 @@ public:
   auto operator=(CLI &&) -> CLI & = delete;
 
   auto run() -> void;
+  // runs commands without prompting until the end of the stream or 'exit', false when any of them failed
+  auto run_batch(std::istream &in_stream) -> bool;
 
 private:
+  [[nodiscard]] static auto parse(std::string const &line) -> std::pair<std::string, std::vector<std::string>>;
+  [[nodiscard]] static auto parse_number(std::string const &value, std::string const &usage,
+                                         std::uint64_t minimum = 0) -> std::uint64_t;
+  // false when the command is unknown or threw
+  auto run_command(std::string const &command, std::vector<std::string> const &args) -> bool;
   [[nodiscard]] auto prompt() -> std::string;
-  auto execute(std::string const &command, std::vector<std::string> args) -> void;
+  [[nodiscard]] auto execute(std::string const &command, std::vector<std::string> args) -> bool;
   static auto help() -> void;
   static auto clear() -> void;
 
@@ -33,12 +52,18 @@ private:
   auto openfs(std::vector<std::string> args) -> void;
 
   auto fsinfo() -> void;
+  auto stats(std::vector<std::string> args) -> void;
+  auto record(std::vector<std::string> args) -> void;
+  auto replay(std::vector<std::string> args) -> void;
   auto dirname(std::vector<std::string> args) -> void;
   auto basename(std::vector<std::string> args) -> void;
   auto pwd() -> void;
   auto ls(std::vector<std::string> args) -> void;
   auto stat(std::vector<std::string> args) -> void;
+  auto du(std::vector<std::string> args) -> void;
   auto cat(std::vector<std::string> args) -> void;
+  auto head(std::vector<std::string> args) -> void;
+  auto tail(std::vector<std::string> args) -> void;
   auto mkdir(std::vector<std::string> args) -> void;
   auto cd(std::vector<std::string> args) -> void;
   auto touch(std::vector<std::string> args) -> void;
@@ -0,0 +1,221 @@
+#include "Workload.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+auto Workload::Report::get_throughput() const noexcept -> double {
+  if (elapsed.count() == 0) return 0;
+  return static_cast<double>(operations_count) / std::chrono::duration<double>(elapsed).count();
+}
+
+auto Workload::is_replayable(std::string const &command) -> bool {
+  static std::vector<std::string> const COMMANDS = {"pwd", "ls",    "stat",  "du", "cat", "head", "tail",   "mkdir",
+                                                    "cd",  "touch", "rmdir", "rm", "cp",  "mv",   "import", "export"};
+  return std::find(COMMANDS.begin(), COMMANDS.end(), command) != COMMANDS.end();
+}
+
+auto Workload::parse_number(std::string const &value) -> std::optional<std::uint64_t> {
+  std::uint64_t number = 0;
+  auto const *end = value.data() + value.size(); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  auto [last, error] = std::from_chars(value.data(), end, number);
+  if (value.empty() || error != std::errc() || last != end) return std::nullopt;
+  return number;
+}
+
+auto Workload::write(std::ostream &out_stream, Operation const &operation) -> void {
+  out_stream << operation.start.count() << ' ' << operation.duration.count() << ' ' << operation.command;
+  for (auto const &arg : operation.args) out_stream << ' ' << arg;
+  out_stream << '\n';
+}
+
+auto Workload::read(std::istream &in_stream) -> std::vector<Operation> {
+  std::vector<Operation> operations;
+
+  std::string line;
+  std::uint64_t line_number = 0;
+  while (std::getline(in_stream, line)) {
+    ++line_number;
+    if (line.empty() || line[0] == '#') continue;
+
+    std::istringstream iss(line);
+    std::int64_t start = 0;
+    std::int64_t duration = 0;
+    Operation operation{};
+    if (!(iss >> start >> duration >> operation.command)) {
+      throw std::invalid_argument("Malformed trace line " + std::to_string(line_number));
+    }
+    operation.start = std::chrono::microseconds(start);
+    operation.duration = std::chrono::nanoseconds(duration);
+
+    std::string arg;
+    while (iss >> arg) operation.args.push_back(arg);
+    operations.push_back(std::move(operation));
+  }
+
+  return operations;
+}
+
+auto Workload::replay(FileSystem const &file_system, std::vector<Operation> const &operations, Report &report,
+                      std::size_t threads) -> void {
+  threads = std::max<std::size_t>(1, threads);
+
+  // histograms are shared by the threads, so every command gets one before they start
+  for (auto const &operation : operations) report.command_latencies.try_emplace(operation.command);
+
+  std::atomic<std::uint64_t> failures_count = 0;
+  auto run = [&](FileSystem replayer, std::string const &root) {
+    for (auto const &operation : operations) {
+      auto start = std::chrono::steady_clock::now();
+      try {
+        apply(replayer, operation, root);
+      } catch (std::exception const &) { ++failures_count; }
+      auto latency = std::chrono::steady_clock::now() - start;
+      report.latency.record(latency);
+      report.command_latencies.at(operation.command).record(latency);
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  if (threads == 1) {
+    run(file_system, "");
+  } else {
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+      auto root = "/replay" + std::to_string(i);
+      auto replayer = file_system;
+      replayer.mkdir(root);
+      replayer.cd(root);
+      workers.emplace_back(run, std::move(replayer), root);
+    }
+    for (auto &worker : workers) worker.join();
+  }
+  report.elapsed = std::chrono::steady_clock::now() - start;
+
+  report.operations_count = operations.size() * threads;
+  report.failures_count = failures_count;
+}
+
+auto Workload::apply(FileSystem &file_system, Operation const &operation, std::string const &root) -> void {
+  auto const &command = operation.command;
+
+  // flags keep their place, everything else is a path of the traced file system unless the command says otherwise
+  std::vector<std::string> args;
+  std::vector<std::string> flags;
+  for (std::size_t i = 0; i < operation.args.size(); ++i) {
+    auto const &arg = operation.args[i];
+    auto takes_value = arg == "-j" || arg == "-c" || arg == "--offset" || arg == "--length";
+    if (arg == "-r" || arg == "-l" || arg == "--reflink" || arg == "--tar") {
+      flags.push_back(arg);
+    } else if (takes_value && i + 1 < operation.args.size()) {
+      flags.push_back(arg);
+      flags.push_back(operation.args[++i]);
+    } else {
+      args.push_back(arg);
+    }
+  }
+  auto has_flag = [&flags](std::string const &flag) {
+    return std::find(flags.begin(), flags.end(), flag) != flags.end();
+  };
+  auto get_value = [&flags, &command](std::string const &flag, std::optional<std::uint64_t> fallback) {
+    auto found = std::find(flags.begin(), flags.end(), flag);
+    if (found == flags.end()) {
+      if (!fallback.has_value()) throw std::invalid_argument("Missing " + flag + " for " + command);
+      return fallback.value();
+    }
+    auto value = parse_number(*(found + 1));
+    if (!value.has_value()) throw std::invalid_argument("Invalid value of " + flag + " for " + command);
+    return value.value();
+  };
+  auto threads = get_value("-j", 1);
+  if (threads == 0) throw std::invalid_argument("Invalid value of -j for " + command);
+  auto fs_path = [&root](std::string const &path) { return !path.empty() && path[0] == '/' ? root + path : path; };
+  auto expect_args = [&args, &command](std::size_t count) {
+    if (args.size() != count) throw std::invalid_argument("Wrong number of arguments for " + command);
+  };
+
+  std::ostream discard(nullptr); // replay measures the file system, not the terminal
+  if (command == "pwd") {
+    static_cast<void>(file_system.pwd());
+  } else if (command == "ls") {
+    auto cursor = file_system.readdir(args.empty() ? "." : fs_path(args[0]), !has_flag("-l"));
+    while (!cursor.next().empty()) {}
+  } else if (command == "stat") {
+    expect_args(1);
+    static_cast<void>(file_system.stat(fs_path(args[0])));
+  } else if (command == "du") {
+    expect_args(1);
+    static_cast<void>(file_system.du(fs_path(args[0])));
+  } else if (command == "cat") {
+    expect_args(1);
+    file_system.cat(fs_path(args[0]), discard, get_value("--offset", 0),
+                    get_value("--length", std::numeric_limits<std::uint64_t>::max()));
+  } else if (command == "head") {
+    expect_args(1);
+    file_system.cat(fs_path(args[0]), discard, 0, get_value("-c", std::nullopt));
+  } else if (command == "tail") {
+    expect_args(1);
+    file_system.tail(fs_path(args[0]), discard, get_value("-c", std::nullopt));
+  } else if (command == "mkdir") {
+    expect_args(1);
+    file_system.mkdir(fs_path(args[0]));
+  } else if (command == "cd") {
+    expect_args(1);
+    file_system.cd(args[0] == "/" && !root.empty() ? root : fs_path(args[0]));
+  } else if (command == "touch") {
+    expect_args(1);
+    file_system.touch(fs_path(args[0]));
+  } else if (command == "rmdir") {
+    expect_args(1);
+    file_system.rmdir(fs_path(args[0]));
+  } else if (command == "rm") {
+    expect_args(1);
+    file_system.rm(fs_path(args[0]), has_flag("-r"));
+  } else if (command == "cp") {
+    expect_args(2);
+    file_system.cp(fs_path(args[0]), fs_path(args[1]), has_flag("-r"), has_flag("--reflink"), threads);
+  } else if (command == "mv") {
+    expect_args(2);
+    file_system.mv(fs_path(args[0]), fs_path(args[1]), has_flag("-r"));
+  } else if (command == "import") {
+    expect_args(2);
+    if (has_flag("-r")) {
+      file_system.import_dir(args[0], fs_path(args[1]), threads);
+      return;
+    }
+    if (!has_flag("--tar")) {
+      file_system.import_from_host(args[0], fs_path(args[1]));
+      return;
+    }
+    std::ifstream in_stream(args[0], std::ios::binary);
+    if (!in_stream.is_open()) throw std::invalid_argument("Cannot open " + args[0]);
+    file_system.import_tar(in_stream, fs_path(args[1]));
+  } else if (command == "export") {
+    expect_args(2);
+    if (has_flag("-r")) throw std::invalid_argument("Cannot replay export -r, it writes to the host");
+    if (has_flag("--tar")) {
+      file_system.export_tar(fs_path(args[0]), discard);
+    } else {
+      file_system.export_file(fs_path(args[0]), discard);
+    }
+  } else {
+    throw std::invalid_argument("Cannot replay " + command);
+  }
+}
+
+auto Workload::to_string(Report const &report) -> std::string {
+  std::stringstream stream;
+  stream << "Replayed " << report.operations_count << " operations (" << report.failures_count << " failed) in "
+         << std::fixed << std::setprecision(1) << std::chrono::duration<double, std::milli>(report.elapsed).count()
+         << " ms, " << report.get_throughput() << " ops/s\n";
+  stream << "all: " << LatencyHistogram::to_string(report.latency.summary()) << '\n';
+  for (auto const &[command, histogram] : report.command_latencies) {
+    stream << command << ": " << LatencyHistogram::to_string(histogram.summary()) << '\n';
+  }
+  return stream.str();
+}
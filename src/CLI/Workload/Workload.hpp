@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../../FileSystem/FileSystem.hpp"
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// A recorded stream of CLI commands and the replay driver for it.
+// A trace is a text file with one command per line, "<start_us> <duration_ns> <command> <args...>", where start_us
+// counts from the start of the recording; lines starting with '#' are comments.
+// Replay runs the commands against a file system as fast as it can. With several threads, every thread replays the
+// whole trace in its own directory /replay<i>, absolute paths of the trace are moved under it.
+class Workload {
+public:
+  struct Operation {
+    std::chrono::microseconds start;
+    std::chrono::nanoseconds duration;
+    std::string command;
+    std::vector<std::string> args;
+  };
+
+  struct Report {
+    std::uint64_t operations_count = 0;
+    std::uint64_t failures_count = 0;
+    std::chrono::nanoseconds elapsed{0};
+    LatencyHistogram latency;
+    std::map<std::string, LatencyHistogram> command_latencies;
+
+    [[nodiscard]] auto get_throughput() const noexcept -> double; // operations per second
+  };
+
+  static auto is_replayable(std::string const &command) -> bool;
+  // a non-negative decimal argument, nullopt for anything else
+  [[nodiscard]] static auto parse_number(std::string const &value) -> std::optional<std::uint64_t>;
+  static auto write(std::ostream &out_stream, Operation const &operation) -> void;
+  [[nodiscard]] static auto read(std::istream &in_stream) -> std::vector<Operation>;
+
+  // histograms cannot be moved, so the report is filled in place
+  static auto replay(FileSystem const &file_system, std::vector<Operation> const &operations, Report &report,
+                     std::size_t threads = 1) -> void;
+  static auto apply(FileSystem &file_system, Operation const &operation, std::string const &root = "") -> void;
+
+  static auto to_string(Report const &report) -> std::string;
+};
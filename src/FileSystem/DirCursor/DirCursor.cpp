@@ -0,0 +1,27 @@
+#include "DirCursor.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+DirCursor::DirCursor(std::vector<std::uint64_t> clusters, std::size_t chunk_size, Loader loader)
+    : clusters_(std::move(clusters)), chunk_size_(chunk_size), loader_(std::move(loader)) {
+  if (chunk_size_ == 0) throw std::invalid_argument("Chunk size must be positive");
+}
+
+auto DirCursor::next() -> std::vector<Entry> {
+  // a chunk whose entries all left the directory comes back empty, the cursor moves on to the next one
+  while (!is_done()) {
+    auto end = std::min(clusters_.size(), position_ + chunk_size_);
+    std::vector<std::uint64_t> const chunk(clusters_.begin() + static_cast<std::int64_t>(position_),
+                                           clusters_.begin() + static_cast<std::int64_t>(end));
+    position_ = end;
+
+    auto entries = loader_(chunk);
+    if (!entries.empty()) return entries;
+  }
+  return {};
+}
+
+auto DirCursor::is_done() const noexcept -> bool { return position_ >= clusters_.size(); }
+
+auto DirCursor::get_count() const noexcept -> std::size_t { return clusters_.size(); }
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../Metadata/Metadata.hpp"
+#include <functional>
+#include <optional>
+#include <vector>
+
+// Hands out the entries of a directory a chunk at a time. The child clusters are listed when the cursor is opened,
+// the headers of a chunk are read only when that chunk is asked for, so the first entries of a large directory
+// arrive before the rest of it has been touched.
+class DirCursor {
+public:
+  struct Entry;
+  using Loader = std::function<std::vector<Entry>(std::vector<std::uint64_t> const &clusters)>;
+
+private:
+  std::vector<std::uint64_t> clusters_;
+  std::size_t chunk_size_;
+  std::size_t position_ = 0;
+  Loader loader_;
+
+public:
+  DirCursor(std::vector<std::uint64_t> clusters, std::size_t chunk_size, Loader loader);
+
+  // the next chunk of entries, empty once the directory is exhausted
+  [[nodiscard]] auto next() -> std::vector<Entry>;
+  [[nodiscard]] auto is_done() const noexcept -> bool;
+  [[nodiscard]] auto get_count() const noexcept -> std::size_t;
+};
+
+struct DirCursor::Entry {
+  std::string name;
+  std::uint64_t cluster;
+  bool is_directory;
+  std::optional<Metadata> metadata; // left empty by a names-only cursor
+};
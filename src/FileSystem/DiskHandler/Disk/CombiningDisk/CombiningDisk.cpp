@@ -0,0 +1,230 @@
+#include "CombiningDisk.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+CombiningDisk::CombiningDisk(std::shared_ptr<Disk> disk, std::uint64_t page_size, std::uint64_t page_origin,
+                             Limits limits, std::shared_ptr<IOStats> io_stats)
+    : disk_(std::move(disk)), page_size_(page_size == 0 ? 1 : page_size),
+      page_shift_((page_size_ - page_origin % page_size_) % page_size_), limits_(limits),
+      io_stats_(std::move(io_stats)) {}
+
+CombiningDisk::~CombiningDisk() {
+  try {
+    flush();
+  } catch (...) {} // NOLINT(bugprone-empty-catch) nothing sensible is left to do with a failing disk here
+}
+
+auto CombiningDisk::read_at(std::uint64_t offset, std::uint64_t size) -> std::vector<std::byte> {
+  std::shared_lock lock(mutex_);
+  auto block = disk_->read_at(offset, size);
+  overlay(flushing_, offset, block, size);
+  overlay(pages_, offset, block, size);
+  return block;
+}
+
+auto CombiningDisk::write_at(std::uint64_t offset, std::vector<std::byte> const &bytes) -> void {
+  if (bytes.size() >= limits_.max_dirty_bytes) {
+    // too big to be worth buffering, pending writes go first so the order on disk is kept
+    std::lock_guard flush_lock(flush_mutex_);
+    flush_pages();
+    disk_->write_at(offset, bytes);
+    return;
+  }
+
+  bool over_limits = false;
+  {
+    std::unique_lock lock(mutex_);
+    buffer(offset, bytes);
+    over_limits = is_over_limits();
+  }
+  if (over_limits) flush();
+}
+
+auto CombiningDisk::read_batch(std::vector<ReadRequest> const &requests) -> std::vector<std::vector<std::byte>> {
+  std::shared_lock lock(mutex_);
+  auto blocks = disk_->read_batch(requests);
+  for (std::size_t i = 0; i < requests.size(); ++i) {
+    overlay(flushing_, requests[i].offset, blocks[i], requests[i].size);
+    overlay(pages_, requests[i].offset, blocks[i], requests[i].size);
+  }
+  return blocks;
+}
+
+auto CombiningDisk::write_batch(std::vector<WriteRequest> const &requests) -> void {
+  std::uint64_t batch_size = 0;
+  for (auto const &request : requests) batch_size += request.bytes.size();
+
+  if (batch_size >= limits_.max_dirty_bytes) {
+    std::lock_guard flush_lock(flush_mutex_);
+    flush_pages();
+    disk_->write_batch(requests);
+    return;
+  }
+
+  bool over_limits = false;
+  {
+    std::unique_lock lock(mutex_);
+    for (auto const &request : requests) buffer(request.offset, request.bytes);
+    over_limits = is_over_limits();
+  }
+  if (over_limits) flush();
+}
+
+auto CombiningDisk::copy_to_fd(std::uint64_t offset, std::uint64_t size, int fd, std::uint64_t fd_offset) -> bool {
+  if (is_pending(offset, size)) flush();
+  return disk_->copy_to_fd(offset, size, fd, fd_offset);
+}
+
+auto CombiningDisk::copy_from_fd(int fd, std::uint64_t fd_offset, std::uint64_t offset, std::uint64_t size) -> bool {
+  if (is_pending(offset, size)) flush();
+  return disk_->copy_from_fd(fd, fd_offset, offset, size);
+}
+
+auto CombiningDisk::flush() -> void {
+  std::lock_guard flush_lock(flush_mutex_);
+  flush_pages();
+}
+
+auto CombiningDisk::get_dirty_bytes() const -> std::uint64_t {
+  std::shared_lock lock(mutex_);
+  return dirty_bytes_;
+}
+
+auto CombiningDisk::get_dirty_age() const -> std::chrono::steady_clock::duration {
+  std::shared_lock lock(mutex_);
+  if (pages_.empty()) return std::chrono::steady_clock::duration::zero();
+  return std::chrono::steady_clock::now() - oldest_write_;
+}
+
+auto CombiningDisk::is_pending(std::uint64_t offset, std::uint64_t size) const -> bool {
+  if (size == 0) return false;
+  auto first_page = (offset + page_shift_) / page_size_;
+  auto last_page = (offset + size - 1 + page_shift_) / page_size_;
+
+  std::shared_lock lock(mutex_);
+  auto is_in = [&](std::map<std::uint64_t, Page> const &pages) {
+    auto page = pages.lower_bound(first_page);
+    return page != pages.end() && page->first <= last_page;
+  };
+  return is_in(pages_) || is_in(flushing_);
+}
+
+auto CombiningDisk::buffer(std::uint64_t offset, std::vector<std::byte> const &bytes) -> void {
+  if (bytes.empty()) return;
+  if (pages_.empty()) oldest_write_ = std::chrono::steady_clock::now();
+
+  std::uint64_t written = 0;
+  while (written < bytes.size()) {
+    auto shifted = offset + written + page_shift_;
+    auto &page = pages_[shifted / page_size_];
+    if (page.bytes.empty()) page.bytes.resize(page_size_);
+
+    auto begin = shifted % page_size_;
+    auto end = std::min(page_size_, begin + (bytes.size() - written));
+    std::copy(bytes.begin() + static_cast<std::int64_t>(written),
+              bytes.begin() + static_cast<std::int64_t>(written + end - begin),
+              page.bytes.begin() + static_cast<std::int64_t>(begin));
+    written += end - begin;
+
+    // merge the new range with every range it overlaps or touches
+    auto &ranges = page.dirty_ranges;
+    auto first = std::lower_bound(ranges.begin(), ranges.end(), begin,
+                                  [](auto const &range, std::uint64_t value) { return range.second < value; });
+    auto last = first;
+    while (last != ranges.end() && last->first <= end) {
+      dirty_bytes_ -= last->second - last->first;
+      begin = std::min(begin, last->first);
+      end = std::max(end, last->second);
+      ++last;
+    }
+    first = ranges.erase(first, last);
+    ranges.insert(first, {begin, end});
+    dirty_bytes_ += end - begin;
+  }
+}
+
+auto CombiningDisk::overlay(std::map<std::uint64_t, Page> const &pages, std::uint64_t offset,
+                            std::vector<std::byte> &block, std::uint64_t size) const -> void {
+  if (pages.empty() || size == 0) return;
+
+  auto first_page = pages.lower_bound((offset + page_shift_) / page_size_);
+  auto end_page = pages.upper_bound((offset + size - 1 + page_shift_) / page_size_);
+  for (auto page = first_page; page != end_page; ++page) {
+    for (auto const &range : page->second.dirty_ranges) {
+      // ranges are stored relative to the shifted page start, which never underflows for a dirty range
+      auto range_begin = page->first * page_size_ + range.first - page_shift_;
+      auto range_end = page->first * page_size_ + range.second - page_shift_;
+      auto begin = std::max(range_begin, offset);
+      auto end = std::min(range_end, offset + size);
+      if (begin >= end) continue;
+
+      // pending bytes past the current end of the image extend the block
+      if (block.size() < end - offset) block.resize(end - offset, std::byte{0});
+      auto source =
+          page->second.bytes.begin() + static_cast<std::int64_t>(begin + page_shift_ - page->first * page_size_);
+      std::copy(source, source + static_cast<std::int64_t>(end - begin),
+                block.begin() + static_cast<std::int64_t>(begin - offset));
+    }
+  }
+}
+
+auto CombiningDisk::is_over_limits() const -> bool {
+  if (pages_.empty()) return false;
+  auto age = std::chrono::steady_clock::now() - oldest_write_;
+  return dirty_bytes_ >= limits_.max_dirty_bytes || age >= limits_.max_age;
+}
+
+auto CombiningDisk::flush_pages() -> void {
+  // the pages move aside so writes keep landing in the buffer while the flush runs; flush_mutex_ is held by the
+  // caller, so flushing_ only changes here
+  std::chrono::steady_clock::time_point oldest_write;
+  {
+    std::unique_lock lock(mutex_);
+    if (pages_.empty()) return;
+    flushing_ = std::move(pages_);
+    pages_.clear();
+    dirty_bytes_ = 0;
+    oldest_write = oldest_write_;
+  }
+
+  try {
+    disk_->write_batch(to_requests(flushing_));
+    if (io_stats_) io_stats_->record_flush();
+  } catch (...) {
+    // keep everything pending, writes made during the flush stay on top of the ones that failed
+    std::unique_lock lock(mutex_);
+    auto newer = std::exchange(pages_, std::move(flushing_));
+    flushing_.clear();
+    dirty_bytes_ = 0;
+    for (auto const &[index, page] : pages_) {
+      for (auto const &range : page.dirty_ranges) dirty_bytes_ += range.second - range.first;
+    }
+    for (auto const &request : to_requests(newer)) buffer(request.offset, request.bytes);
+    oldest_write_ = oldest_write;
+    throw;
+  }
+
+  std::unique_lock lock(mutex_);
+  flushing_.clear();
+}
+
+auto CombiningDisk::to_requests(std::map<std::uint64_t, Page> const &pages) const -> std::vector<WriteRequest> {
+  std::vector<WriteRequest> requests;
+  for (auto const &[index, page] : pages) {
+    for (auto const &range : page.dirty_ranges) {
+      auto offset = index * page_size_ + range.first - page_shift_;
+      auto begin = page.bytes.begin() + static_cast<std::int64_t>(range.first);
+      auto end = page.bytes.begin() + static_cast<std::int64_t>(range.second);
+
+      // a range running up to the page end continues into the next page, both go out as one write
+      if (!requests.empty() && requests.back().offset + requests.back().bytes.size() == offset) {
+        requests.back().bytes.insert(requests.back().bytes.end(), begin, end);
+      } else {
+        requests.push_back({offset, std::vector<std::byte>(begin, end)});
+      }
+    }
+  }
+  return requests;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../../../IOStats/IOStats.hpp"
+#include "../Disk.hpp"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+
+// Write-combining layer over another disk. Writes are kept per page (a cluster, aligned to the first cluster)
+// as merged dirty ranges, so a header write and the data that follows it reach the disk as one write.
+// Pending bytes are written in offset order by flush(), when they exceed the dirty-bytes limit, when the oldest
+// is older than the age limit on the next write, and on destruction. Reads see pending writes, including the ones
+// a flush is still writing, so a flush never holds up readers or writers of the buffer.
+class CombiningDisk : public Disk {
+public:
+  struct Limits {
+    std::uint64_t max_dirty_bytes;
+    std::chrono::milliseconds max_age;
+  };
+
+private:
+  struct Page {
+    std::vector<std::byte> bytes;
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> dirty_ranges; // sorted, disjoint, [begin, end) in page
+  };
+
+  std::shared_ptr<Disk> disk_;
+  std::uint64_t page_size_;
+  std::uint64_t page_shift_;
+  Limits limits_;
+  std::shared_ptr<IOStats> io_stats_; // counts flushes, optional
+
+  std::map<std::uint64_t, Page> pages_; // page index -> page, ordered so flushes go out by offset
+  std::map<std::uint64_t, Page> flushing_; // pages taken by the running flush, still visible to reads
+  std::uint64_t dirty_bytes_ = 0;
+  std::chrono::steady_clock::time_point oldest_write_;
+
+  mutable std::shared_mutex mutex_; // guards the page maps
+  std::mutex flush_mutex_;          // one flush at a time, taken before mutex_
+
+public:
+  CombiningDisk(std::shared_ptr<Disk> disk, std::uint64_t page_size, std::uint64_t page_origin, Limits limits,
+                std::shared_ptr<IOStats> io_stats = nullptr);
+  CombiningDisk(const CombiningDisk &) = delete;
+  CombiningDisk(CombiningDisk &&) = delete;
+
+  ~CombiningDisk() override;
+  auto operator=(const CombiningDisk &) -> CombiningDisk & = delete;
+  auto operator=(CombiningDisk &&) -> CombiningDisk & = delete;
+
+  [[nodiscard]] auto read_at(std::uint64_t offset, std::uint64_t size) -> std::vector<std::byte> override;
+  auto write_at(std::uint64_t offset, std::vector<std::byte> const &bytes) -> void override;
+  [[nodiscard]] auto read_batch(std::vector<ReadRequest> const &requests)
+      -> std::vector<std::vector<std::byte>> override;
+  auto write_batch(std::vector<WriteRequest> const &requests) -> void override;
+  // pending writes in the range are flushed first, so the kernel copy neither misses them nor is overwritten later
+  [[nodiscard]] auto copy_to_fd(std::uint64_t offset, std::uint64_t size, int fd, std::uint64_t fd_offset)
+      -> bool override;
+  [[nodiscard]] auto copy_from_fd(int fd, std::uint64_t fd_offset, std::uint64_t offset, std::uint64_t size)
+      -> bool override;
+
+  auto flush() -> void;
+  [[nodiscard]] auto get_dirty_bytes() const -> std::uint64_t;
+  [[nodiscard]] auto get_dirty_age() const -> std::chrono::steady_clock::duration;
+
+private:
+  auto buffer(std::uint64_t offset, std::vector<std::byte> const &bytes) -> void;
+  auto overlay(std::map<std::uint64_t, Page> const &pages, std::uint64_t offset, std::vector<std::byte> &block,
+               std::uint64_t size) const -> void;
+  [[nodiscard]] auto is_over_limits() const -> bool;
+  [[nodiscard]] auto is_pending(std::uint64_t offset, std::uint64_t size) const -> bool;
+  auto flush_pages() -> void;
+  [[nodiscard]] auto to_requests(std::map<std::uint64_t, Page> const &pages) const -> std::vector<WriteRequest>;
+};
@@ -0,0 +1,105 @@
+#include "Disk.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+auto Disk::read_batch(std::vector<ReadRequest> const &requests) -> std::vector<std::vector<std::byte>> {
+  std::vector<std::vector<std::byte>> blocks;
+  blocks.reserve(requests.size());
+  for (auto const &request : requests) blocks.push_back(read_at(request.offset, request.size));
+  return blocks;
+}
+
+auto Disk::write_batch(std::vector<WriteRequest> const &requests) -> void {
+  if (!is_scheduled(requests)) {
+    write_batch(schedule(requests));
+    return;
+  }
+  for (auto const &request : requests) write_at(request.offset, request.bytes);
+}
+
+auto Disk::copy_to_fd(std::uint64_t /*offset*/, std::uint64_t /*size*/, int /*fd*/, std::uint64_t /*fd_offset*/)
+    -> bool {
+  return false;
+}
+
+auto Disk::copy_from_fd(int /*fd*/, std::uint64_t /*fd_offset*/, std::uint64_t /*offset*/, std::uint64_t /*size*/)
+    -> bool {
+  return false;
+}
+
+auto Disk::is_scheduled(std::vector<WriteRequest> const &requests) -> bool {
+  for (std::size_t i = 1; i < requests.size(); ++i) {
+    if (requests[i - 1].offset + requests[i - 1].bytes.size() > requests[i].offset) return false;
+  }
+  return true;
+}
+
+auto Disk::schedule(std::vector<WriteRequest> const &requests) -> std::vector<WriteRequest> {
+  std::vector<std::size_t> order(requests.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&requests](std::size_t lhs, std::size_t rhs) {
+    return requests[lhs].offset < requests[rhs].offset;
+  });
+
+  std::vector<WriteRequest> scheduled;
+  std::size_t begin = 0;
+  while (begin < order.size()) {
+    // collect every request that overlaps the run started at begin
+    auto run_offset = requests[order[begin]].offset;
+    auto run_end = run_offset + requests[order[begin]].bytes.size();
+    auto end = begin + 1;
+    while (end < order.size() && requests[order[end]].offset < run_end) {
+      run_end = std::max(run_end, requests[order[end]].offset + requests[order[end]].bytes.size());
+      ++end;
+    }
+
+    if (end - begin == 1) {
+      scheduled.push_back(requests[order[begin]]);
+    } else {
+      // replay the run in submission order so the last write to a byte wins
+      std::sort(order.begin() + static_cast<std::int64_t>(begin), order.begin() + static_cast<std::int64_t>(end));
+      WriteRequest merged{run_offset, std::vector<std::byte>(run_end - run_offset)};
+      for (auto i = begin; i < end; ++i) {
+        auto const &request = requests[order[i]];
+        std::copy(request.bytes.begin(), request.bytes.end(),
+                  merged.bytes.begin() + static_cast<std::int64_t>(request.offset - run_offset));
+      }
+      scheduled.push_back(std::move(merged));
+    }
+    begin = end;
+  }
+
+  return scheduled;
+}
+
+auto Disk::group_adjacent(std::vector<ReadRequest> const &requests)
+    -> std::vector<std::pair<std::size_t, std::size_t>> {
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> extents;
+  extents.reserve(requests.size());
+  for (auto const &request : requests) extents.emplace_back(request.offset, request.size);
+  return group_adjacent(extents);
+}
+
+auto Disk::group_adjacent(std::vector<WriteRequest> const &requests)
+    -> std::vector<std::pair<std::size_t, std::size_t>> {
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> extents;
+  extents.reserve(requests.size());
+  for (auto const &request : requests) extents.emplace_back(request.offset, request.bytes.size());
+  return group_adjacent(extents);
+}
+
+auto Disk::group_adjacent(std::vector<std::pair<std::uint64_t, std::uint64_t>> const &extents)
+    -> std::vector<std::pair<std::size_t, std::size_t>> {
+  std::vector<std::pair<std::size_t, std::size_t>> groups;
+
+  std::size_t begin = 0;
+  for (std::size_t i = 1; i <= extents.size(); ++i) {
+    auto is_adjacent = i < extents.size() && extents[i - 1].first + extents[i - 1].second == extents[i].first;
+    if (is_adjacent && i - begin < MAX_GROUP_SIZE) continue;
+    groups.emplace_back(begin, i);
+    begin = i;
+  }
+
+  return groups;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Positional access to the image. Implementations must be safe to share between threads.
+class Disk {
+  static const std::size_t MAX_GROUP_SIZE = 1024; // IOV_MAX on Linux
+
+public:
+  Disk() = default;
+  Disk(const Disk &) = delete;
+  Disk(Disk &&) = delete;
+
+  virtual ~Disk() = default;
+  auto operator=(const Disk &) -> Disk & = delete;
+  auto operator=(Disk &&) -> Disk & = delete;
+
+  struct ReadRequest {
+    std::uint64_t offset;
+    std::uint64_t size;
+  };
+
+  struct WriteRequest {
+    std::uint64_t offset;
+    std::vector<std::byte> bytes;
+  };
+
+  [[nodiscard]] virtual auto read_at(std::uint64_t offset, std::uint64_t size) -> std::vector<std::byte> = 0;
+  virtual auto write_at(std::uint64_t offset, std::vector<std::byte> const &bytes) -> void = 0;
+
+  // serves every request, implementations may submit them together; reads past the end come back short
+  [[nodiscard]] virtual auto read_batch(std::vector<ReadRequest> const &requests)
+      -> std::vector<std::vector<std::byte>>;
+  virtual auto write_batch(std::vector<WriteRequest> const &requests) -> void;
+
+  // move bytes between the image and a host file descriptor inside the kernel; false when this disk cannot, the
+  // caller then copies them through memory
+  [[nodiscard]] virtual auto copy_to_fd(std::uint64_t offset, std::uint64_t size, int fd, std::uint64_t fd_offset)
+      -> bool;
+  [[nodiscard]] virtual auto copy_from_fd(int fd, std::uint64_t fd_offset, std::uint64_t offset, std::uint64_t size)
+      -> bool;
+
+protected:
+  // elevator order: ascending offsets, overlapping requests merged into one with the later bytes on top, so the
+  // writes of a batch can go out in one sweep and in any order
+  [[nodiscard]] static auto is_scheduled(std::vector<WriteRequest> const &requests) -> bool;
+  [[nodiscard]] static auto schedule(std::vector<WriteRequest> const &requests) -> std::vector<WriteRequest>;
+
+  // splits requests into [begin, end) groups that sit back to back on disk and fit one vectored call
+  [[nodiscard]] static auto group_adjacent(std::vector<ReadRequest> const &requests)
+      -> std::vector<std::pair<std::size_t, std::size_t>>;
+  [[nodiscard]] static auto group_adjacent(std::vector<WriteRequest> const &requests)
+      -> std::vector<std::pair<std::size_t, std::size_t>>;
+
+private:
+  [[nodiscard]] static auto group_adjacent(std::vector<std::pair<std::uint64_t, std::uint64_t>> const &extents)
+      -> std::vector<std::pair<std::size_t, std::size_t>>;
+};
@@ -0,0 +1,204 @@
+#ifndef _WIN32
+
+#include "FileDisk.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+FileDisk::FileDisk(std::string const &path)
+    : fd_(::open(path.c_str(), O_RDWR | O_CLOEXEC)) { // NOLINT(cppcoreguidelines-pro-type-vararg)
+  if (fd_ < 0) throw std::runtime_error("Cannot open file " + path);
+}
+
+FileDisk::~FileDisk() { ::close(fd_); }
+
+auto FileDisk::get_fd() const noexcept -> int { return fd_; }
+
+auto FileDisk::read_at(std::uint64_t offset, std::uint64_t size) -> std::vector<std::byte> {
+  std::vector<std::byte> block(size);
+
+  std::uint64_t read_count = 0;
+  while (read_count < size) {
+    auto result = ::pread(fd_, block.data() + read_count, size - read_count, static_cast<off_t>(offset + read_count));
+    if (result < 0 && errno == EINTR) continue;
+    if (result < 0) throw std::runtime_error("Cannot read from disk");
+    if (result == 0) break; // end of the image
+    read_count += static_cast<std::uint64_t>(result);
+  }
+
+  block.resize(read_count);
+  return block;
+}
+
+auto FileDisk::write_at(std::uint64_t offset, std::vector<std::byte> const &bytes) -> void {
+  std::uint64_t written_count = 0;
+  while (written_count < bytes.size()) {
+    auto result = ::pwrite(fd_, bytes.data() + written_count, bytes.size() - written_count,
+                           static_cast<off_t>(offset + written_count));
+    if (result < 0 && errno == EINTR) continue;
+    if (result < 0) throw std::runtime_error("Cannot write to disk");
+    written_count += static_cast<std::uint64_t>(result);
+  }
+}
+
+auto FileDisk::read_batch(std::vector<ReadRequest> const &requests) -> std::vector<std::vector<std::byte>> {
+  std::vector<std::vector<std::byte>> blocks;
+  blocks.reserve(requests.size());
+  for (auto const &request : requests) blocks.emplace_back(request.size);
+
+  for (auto group : group_adjacent(requests)) {
+    std::vector<iovec> iovecs;
+    iovecs.reserve(group.second - group.first);
+    for (auto i = group.first; i < group.second; ++i) iovecs.push_back({blocks[i].data(), blocks[i].size()});
+
+    auto result = ::preadv(fd_, iovecs.data(), static_cast<int>(iovecs.size()),
+                           static_cast<off_t>(requests[group.first].offset));
+    if (result < 0 && errno != EINTR) throw std::runtime_error("Cannot read from disk");
+    finish_reads(requests, group, result < 0 ? 0 : static_cast<std::uint64_t>(result), blocks);
+  }
+
+  return blocks;
+}
+
+auto FileDisk::write_batch(std::vector<WriteRequest> const &requests) -> void {
+  if (!is_scheduled(requests)) {
+    write_batch(schedule(requests));
+    return;
+  }
+
+  for (auto group : group_adjacent(requests)) {
+    std::vector<iovec> iovecs;
+    iovecs.reserve(group.second - group.first);
+    for (auto i = group.first; i < group.second; ++i) {
+      // pwritev only reads the buffers, iovec just has no const variant
+      auto *data = const_cast<std::byte *>(requests[i].bytes.data()); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+      iovecs.push_back({data, requests[i].bytes.size()});
+    }
+
+    auto result = ::pwritev(fd_, iovecs.data(), static_cast<int>(iovecs.size()),
+                            static_cast<off_t>(requests[group.first].offset));
+    if (result < 0 && errno != EINTR) throw std::runtime_error("Cannot write to disk");
+    finish_writes(requests, group, result < 0 ? 0 : static_cast<std::uint64_t>(result));
+  }
+}
+
+auto FileDisk::copy_to_fd(std::uint64_t offset, std::uint64_t size, int fd, std::uint64_t fd_offset) -> bool {
+  return copy_range(fd_, offset, fd, fd_offset, size);
+}
+
+auto FileDisk::copy_from_fd(int fd, std::uint64_t fd_offset, std::uint64_t offset, std::uint64_t size) -> bool {
+  return copy_range(fd, fd_offset, fd_, offset, size);
+}
+
+#ifdef __linux__
+
+auto FileDisk::copy_range(int in_fd, std::uint64_t in_offset, int out_fd, std::uint64_t out_offset,
+                          std::uint64_t size) -> bool {
+  std::uint64_t copied = 0;
+  while (copied < size) {
+    auto in = static_cast<loff_t>(in_offset + copied);
+    auto out = static_cast<loff_t>(out_offset + copied);
+    auto result = ::copy_file_range(in_fd, &in, out_fd, &out, size - copied, 0);
+    if (result < 0 && errno == EINTR) continue;
+    // older kernels refuse copies across file systems, some file systems refuse them altogether
+    if (result < 0 && (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP)) break;
+    if (result < 0) throw std::runtime_error("Cannot copy between files");
+    if (result == 0) throw std::runtime_error("Unexpected end of file");
+    copied += static_cast<std::uint64_t>(result);
+  }
+  if (copied == size) return true;
+
+  if (splice_range(in_fd, in_offset + copied, out_fd, out_offset + copied, size - copied)) return true;
+  if (copied > 0) throw std::runtime_error("Cannot copy between files");
+  return false;
+}
+
+auto FileDisk::splice_range(int in_fd, std::uint64_t in_offset, int out_fd, std::uint64_t out_offset,
+                            std::uint64_t size) -> bool {
+  const std::uint64_t PIPE_CHUNK_SIZE = 65536; // the default pipe capacity
+
+  std::array<int, 2> pipe_fds{};
+  if (::pipe2(pipe_fds.data(), O_CLOEXEC) != 0) return false;
+  auto close_pipe = [&pipe_fds]() {
+    ::close(pipe_fds[0]);
+    ::close(pipe_fds[1]);
+  };
+
+  std::uint64_t copied = 0;
+  while (copied < size) {
+    auto in = static_cast<loff_t>(in_offset + copied);
+    auto moved = ::splice(in_fd, &in, pipe_fds[1], nullptr, std::min(size - copied, PIPE_CHUNK_SIZE), SPLICE_F_MOVE);
+    if (moved < 0 && errno == EINTR) continue;
+    if (moved <= 0) {
+      auto error = errno;
+      close_pipe();
+      if (moved < 0 && copied == 0 && (error == EINVAL || error == ENOSYS)) return false;
+      throw std::runtime_error(moved == 0 ? "Unexpected end of file" : "Cannot copy between files");
+    }
+
+    // the pipe is drained before the next chunk, what went in has to come out
+    auto left = static_cast<std::uint64_t>(moved);
+    while (left > 0) {
+      auto out = static_cast<loff_t>(out_offset + copied);
+      auto result = ::splice(pipe_fds[0], nullptr, out_fd, &out, left, SPLICE_F_MOVE);
+      if (result < 0 && errno == EINTR) continue;
+      if (result <= 0) {
+        close_pipe();
+        throw std::runtime_error("Cannot copy between files");
+      }
+      left -= static_cast<std::uint64_t>(result);
+      copied += static_cast<std::uint64_t>(result);
+    }
+  }
+
+  close_pipe();
+  return true;
+}
+
+#else
+
+// no kernel copies outside Linux, callers copy through memory
+auto FileDisk::copy_range(int /*in_fd*/, std::uint64_t /*in_offset*/, int /*out_fd*/, std::uint64_t /*out_offset*/,
+                          std::uint64_t /*size*/) -> bool {
+  return false;
+}
+
+auto FileDisk::splice_range(int /*in_fd*/, std::uint64_t /*in_offset*/, int /*out_fd*/,
+                            std::uint64_t /*out_offset*/, std::uint64_t /*size*/) -> bool {
+  return false;
+}
+
+#endif
+
+auto FileDisk::finish_reads(std::vector<ReadRequest> const &requests, std::pair<std::size_t, std::size_t> group,
+                            std::uint64_t done, std::vector<std::vector<std::byte>> &blocks) -> void {
+  for (auto i = group.first; i < group.second; ++i) {
+    auto filled = std::min(done, requests[i].size);
+    done -= filled;
+    if (filled == requests[i].size) continue;
+
+    // a short transfer, pread either finishes the request or runs into the end of the image
+    auto rest = read_at(requests[i].offset + filled, requests[i].size - filled);
+    blocks[i].resize(filled);
+    blocks[i].insert(blocks[i].end(), rest.begin(), rest.end());
+  }
+}
+
+auto FileDisk::finish_writes(std::vector<WriteRequest> const &requests, std::pair<std::size_t, std::size_t> group,
+                             std::uint64_t done) -> void {
+  for (auto i = group.first; i < group.second; ++i) {
+    auto written = std::min<std::uint64_t>(done, requests[i].bytes.size());
+    done -= written;
+    if (written == requests[i].bytes.size()) continue;
+
+    write_at(requests[i].offset + written,
+             std::vector<std::byte>(requests[i].bytes.begin() + static_cast<std::int64_t>(written),
+                                    requests[i].bytes.end()));
+  }
+}
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../Disk.hpp"
+#include <stdexcept>
+#include <string>
+
+// Image file accessed with pread/pwrite, so concurrent callers never share a file offset.
+// Batched requests that sit back to back on disk are merged into one preadv/pwritev.
+class FileDisk : public Disk {
+  int fd_;
+
+public:
+  explicit FileDisk(std::string const &path);
+  FileDisk(const FileDisk &) = delete;
+  FileDisk(FileDisk &&) = delete;
+
+  ~FileDisk() override;
+  auto operator=(const FileDisk &) -> FileDisk & = delete;
+  auto operator=(FileDisk &&) -> FileDisk & = delete;
+
+  [[nodiscard]] auto read_at(std::uint64_t offset, std::uint64_t size) -> std::vector<std::byte> override;
+  auto write_at(std::uint64_t offset, std::vector<std::byte> const &bytes) -> void override;
+  [[nodiscard]] auto read_batch(std::vector<ReadRequest> const &requests)
+      -> std::vector<std::vector<std::byte>> override;
+  auto write_batch(std::vector<WriteRequest> const &requests) -> void override;
+  [[nodiscard]] auto copy_to_fd(std::uint64_t offset, std::uint64_t size, int fd, std::uint64_t fd_offset)
+      -> bool override;
+  [[nodiscard]] auto copy_from_fd(int fd, std::uint64_t fd_offset, std::uint64_t offset, std::uint64_t size)
+      -> bool override;
+
+protected:
+  [[nodiscard]] auto get_fd() const noexcept -> int;
+
+  // copy_file_range, then splice through a pipe; both are positional, so concurrent preads and pwrites are fine
+  [[nodiscard]] static auto copy_range(int in_fd, std::uint64_t in_offset, int out_fd, std::uint64_t out_offset,
+                                       std::uint64_t size) -> bool;
+  [[nodiscard]] static auto splice_range(int in_fd, std::uint64_t in_offset, int out_fd, std::uint64_t out_offset,
+                                         std::uint64_t size) -> bool;
+
+  // complete a group after a vectored call moved `done` bytes, requests it did not fully cover go one by one
+  auto finish_reads(std::vector<ReadRequest> const &requests, std::pair<std::size_t, std::size_t> group,
+                    std::uint64_t done, std::vector<std::vector<std::byte>> &blocks) -> void;
+  auto finish_writes(std::vector<WriteRequest> const &requests, std::pair<std::size_t, std::size_t> group,
+                     std::uint64_t done) -> void;
+};
@@ -0,0 +1,34 @@
+#include "StreamDisk.hpp"
+
+StreamDisk::StreamDisk(std::shared_ptr<std::istream> in_stream, std::shared_ptr<std::ostream> out_stream)
+    : is_(std::move(in_stream)), os_(std::move(out_stream)) {}
+
+auto StreamDisk::read_at(std::uint64_t offset, std::uint64_t size) -> std::vector<std::byte> {
+  if (!is_) throw std::runtime_error("Disk is not readable");
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  is_->seekg(static_cast<std::streamoff>(offset));
+
+  std::vector<std::byte> block(size);
+  is_->read(reinterpret_cast<char *>(block.data()), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            static_cast<std::streamsize>(block.size()));
+
+  auto read_count = static_cast<std::size_t>(is_->gcount());
+  if (read_count < block.size()) {
+    // hitting the end of the image is not an error, the next seek has to succeed
+    is_->clear();
+    block.resize(read_count);
+  }
+
+  return block;
+}
+
+auto StreamDisk::write_at(std::uint64_t offset, std::vector<std::byte> const &bytes) -> void {
+  if (!os_) throw std::runtime_error("Disk is not writable");
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  os_->seekp(static_cast<std::streamoff>(offset));
+  os_->write(reinterpret_cast<const char *>(bytes.data()), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+             static_cast<std::streamsize>(bytes.size()));
+  os_->flush();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../Disk.hpp"
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+
+// Serializes positional access to C++ streams, which share a single seek position.
+class StreamDisk : public Disk {
+  std::shared_ptr<std::istream> is_;
+  std::shared_ptr<std::ostream> os_;
+  std::mutex mutex_;
+
+public:
+  StreamDisk(std::shared_ptr<std::istream> in_stream, std::shared_ptr<std::ostream> out_stream);
+
+  [[nodiscard]] auto read_at(std::uint64_t offset, std::uint64_t size) -> std::vector<std::byte> override;
+  auto write_at(std::uint64_t offset, std::vector<std::byte> const &bytes) -> void override;
+};
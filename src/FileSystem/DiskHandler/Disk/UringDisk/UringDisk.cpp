@@ -0,0 +1,296 @@
+#ifdef FS_HAVE_IO_URING
+
+#include "UringDisk.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+struct UringDisk::Operation {
+  std::uint8_t opcode;
+  std::uint64_t offset;
+  std::vector<iovec> iovecs;
+};
+
+namespace {
+
+auto io_uring_setup(unsigned entries, io_uring_params *params) -> int {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+auto map_ring(int ring_fd, std::size_t size, off_t offset) -> void * {
+  auto *ring = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+  if (ring == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "Cannot map io_uring");
+  return ring;
+}
+
+template <typename T> auto at(void *ring, std::uint32_t offset) -> T * {
+  return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+}
+
+} // namespace
+
+// one io_uring instance, used by a single thread at a time
+class UringDisk::Ring {
+  int fd_ = -1;
+
+  void *sq_ring_ = nullptr;
+  std::size_t sq_ring_size_ = 0;
+  void *cq_ring_ = nullptr;
+  std::size_t cq_ring_size_ = 0;
+  io_uring_sqe *sqes_ = nullptr;
+  std::size_t sqes_size_ = 0;
+
+  unsigned *sq_head_ = nullptr;
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_mask_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned *cq_mask_ = nullptr;
+  io_uring_cqe *cqes_ = nullptr;
+  unsigned entries_ = 0;
+
+public:
+  explicit Ring(unsigned depth);
+  Ring(const Ring &) = delete;
+  Ring(Ring &&) = delete;
+
+  ~Ring();
+  auto operator=(const Ring &) -> Ring & = delete;
+  auto operator=(Ring &&) -> Ring & = delete;
+
+  [[nodiscard]] auto get_entries() const noexcept -> unsigned;
+
+  auto submit(int file_fd, Operation const *operations, unsigned count, std::uint64_t *results) -> void;
+
+private:
+  auto unmap() noexcept -> void;
+  auto reap(unsigned count, std::uint64_t *results) -> int;
+};
+
+UringDisk::Ring::Ring(unsigned depth) {
+  io_uring_params params{};
+  fd_ = io_uring_setup(depth, &params);
+  if (fd_ < 0) throw std::system_error(errno, std::generic_category(), "Cannot set up io_uring");
+
+  try {
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+
+    sq_ring_ = map_ring(fd_, sq_ring_size_, IORING_OFF_SQ_RING);
+    cq_ring_ = (params.features & IORING_FEAT_SINGLE_MMAP) != 0 ? sq_ring_
+                                                                 : map_ring(fd_, cq_ring_size_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(map_ring(fd_, sqes_size_, IORING_OFF_SQES));
+  } catch (...) {
+    unmap();
+    ::close(fd_);
+    throw;
+  }
+
+  sq_head_ = at<unsigned>(sq_ring_, params.sq_off.head);
+  sq_tail_ = at<unsigned>(sq_ring_, params.sq_off.tail);
+  sq_mask_ = at<unsigned>(sq_ring_, params.sq_off.ring_mask);
+  sq_array_ = at<unsigned>(sq_ring_, params.sq_off.array);
+  cq_head_ = at<unsigned>(cq_ring_, params.cq_off.head);
+  cq_tail_ = at<unsigned>(cq_ring_, params.cq_off.tail);
+  cq_mask_ = at<unsigned>(cq_ring_, params.cq_off.ring_mask);
+  cqes_ = at<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+  entries_ = std::min(params.sq_entries, params.cq_entries);
+}
+
+UringDisk::Ring::~Ring() {
+  unmap();
+  ::close(fd_);
+}
+
+auto UringDisk::Ring::get_entries() const noexcept -> unsigned { return entries_; }
+
+auto UringDisk::Ring::submit(int file_fd, Operation const *operations, unsigned count, std::uint64_t *results)
+    -> void {
+  auto tail = *sq_tail_;
+  for (unsigned i = 0; i < count; ++i) {
+    auto index = (tail + i) & *sq_mask_;
+    auto *sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    sqe->opcode = operations[i].opcode;
+    sqe->fd = file_fd;
+    sqe->addr = reinterpret_cast<std::uint64_t>(operations[i].iovecs.data());
+    sqe->len = static_cast<std::uint32_t>(operations[i].iovecs.size());
+    sqe->off = operations[i].offset;
+    sqe->user_data = i;
+    sq_array_[index] = index;
+  }
+  __atomic_store_n(sq_tail_, tail + count, __ATOMIC_RELEASE);
+
+  int submit_error = 0;
+  while (true) {
+    auto submitted = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) - tail;
+    if (submitted == count) break;
+
+    auto result = io_uring_enter(fd_, count - submitted, 0, 0);
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) {
+      submit_error = result < 0 ? errno : EBUSY;
+      break;
+    }
+  }
+
+  // entries the kernel did not take are withdrawn, nothing else submits to this ring and the kernel only reads
+  // the queue inside io_uring_enter
+  auto submitted = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) - tail;
+  if (submitted < count) __atomic_store_n(sq_tail_, tail + submitted, __ATOMIC_RELEASE);
+
+  // every accepted entry has to be reaped before the buffers go out of scope, failures are reported afterwards
+  auto io_error = reap(submitted, results);
+  if (submit_error != 0) throw std::system_error(submit_error, std::generic_category(), "Cannot submit to io_uring");
+  if (io_error != 0) throw std::system_error(io_error, std::generic_category(), "Disk I/O failed");
+}
+
+auto UringDisk::Ring::unmap() noexcept -> void {
+  if (sqes_ != nullptr) ::munmap(sqes_, sqes_size_);
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) ::munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != nullptr) ::munmap(sq_ring_, sq_ring_size_);
+}
+
+auto UringDisk::Ring::reap(unsigned count, std::uint64_t *results) -> int {
+  int error = 0;
+  bool can_wait = true;
+  unsigned completed = 0;
+  while (completed < count) {
+    auto head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      // when the kernel refuses to wait the ring is polled, the entries still own the buffers
+      if (!can_wait) {
+        std::this_thread::yield();
+        continue;
+      }
+      auto result = io_uring_enter(fd_, 0, 1, IORING_ENTER_GETEVENTS);
+      if (result < 0 && errno != EINTR) {
+        if (error == 0) error = errno;
+        can_wait = false;
+      }
+      continue;
+    }
+
+    auto const &cqe = cqes_[head & *cq_mask_];
+    if (cqe.res < 0 && error == 0) error = -cqe.res;
+    results[cqe.user_data] = cqe.res < 0 ? 0 : static_cast<std::uint64_t>(cqe.res);
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    ++completed;
+  }
+  return error;
+}
+
+UringDisk::UringDisk(std::string const &path) : FileDisk(path) {
+  // the first ring is set up right away, so a kernel without io_uring is detected when the disk is opened
+  idle_rings_.push_back(std::make_unique<Ring>(QUEUE_DEPTH));
+}
+
+UringDisk::~UringDisk() = default;
+
+auto UringDisk::read_batch(std::vector<ReadRequest> const &requests) -> std::vector<std::vector<std::byte>> {
+  auto groups = group_adjacent(requests);
+  if (groups.size() < 2) return FileDisk::read_batch(requests);
+
+  std::vector<std::vector<std::byte>> blocks;
+  blocks.reserve(requests.size());
+  for (auto const &request : requests) blocks.emplace_back(request.size);
+
+  std::vector<Operation> operations;
+  operations.reserve(groups.size());
+  for (auto group : groups) {
+    Operation operation{IORING_OP_READV, requests[group.first].offset, {}};
+    for (auto i = group.first; i < group.second; ++i) operation.iovecs.push_back({blocks[i].data(), blocks[i].size()});
+    operations.push_back(std::move(operation));
+  }
+
+  auto results = submit(operations);
+  for (std::size_t i = 0; i < groups.size(); ++i) finish_reads(requests, groups[i], results[i], blocks);
+  return blocks;
+}
+
+auto UringDisk::write_batch(std::vector<WriteRequest> const &requests) -> void {
+  // entries of one submission may complete in any order, the schedule keeps them from overlapping
+  if (!is_scheduled(requests)) {
+    write_batch(schedule(requests));
+    return;
+  }
+
+  auto groups = group_adjacent(requests);
+  if (groups.size() < 2) {
+    FileDisk::write_batch(requests);
+    return;
+  }
+
+  std::vector<Operation> operations;
+  operations.reserve(groups.size());
+  for (auto group : groups) {
+    Operation operation{IORING_OP_WRITEV, requests[group.first].offset, {}};
+    for (auto i = group.first; i < group.second; ++i) {
+      // the kernel only reads from the buffers, iovec just has no const variant
+      auto *data = const_cast<std::byte *>(requests[i].bytes.data()); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+      operation.iovecs.push_back({data, requests[i].bytes.size()});
+    }
+    operations.push_back(std::move(operation));
+  }
+
+  auto results = submit(operations);
+  for (std::size_t i = 0; i < groups.size(); ++i) finish_writes(requests, groups[i], results[i]);
+}
+
+auto UringDisk::submit(std::vector<Operation> const &operations) -> std::vector<std::uint64_t> {
+  std::vector<std::uint64_t> results(operations.size());
+
+  auto ring = acquire_ring();
+  try {
+    for (std::size_t first = 0; first < operations.size(); first += ring->get_entries()) {
+      auto count = static_cast<unsigned>(std::min<std::size_t>(ring->get_entries(), operations.size() - first));
+      ring->submit(get_fd(), &operations[first], count, &results[first]);
+    }
+  } catch (...) {
+    // a failed submission leaves nothing in flight, the ring can be used again
+    release_ring(std::move(ring));
+    throw;
+  }
+  release_ring(std::move(ring));
+
+  return results;
+}
+
+auto UringDisk::acquire_ring() -> std::unique_ptr<Ring> {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!idle_rings_.empty()) {
+      auto ring = std::move(idle_rings_.back());
+      idle_rings_.pop_back();
+      return ring;
+    }
+  }
+  return std::make_unique<Ring>(QUEUE_DEPTH);
+}
+
+auto UringDisk::release_ring(std::unique_ptr<Ring> ring) -> void {
+  std::lock_guard<std::mutex> lock(mutex_);
+  idle_rings_.push_back(std::move(ring));
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+#endif
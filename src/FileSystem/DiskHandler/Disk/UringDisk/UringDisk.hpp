@@ -0,0 +1,45 @@
+#pragma once
+
+#ifdef FS_HAVE_IO_URING
+
+#include "../FileDisk/FileDisk.hpp"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <system_error>
+
+// FileDisk that hands whole batches to the kernel through one io_uring submission, with one vectored entry
+// per group of adjacent requests. Single requests and single groups keep using the FileDisk calls, which need
+// no ring and run in parallel.
+// Every batch takes a ring of its own from a pool that grows with the number of threads doing I/O at once, so
+// batches of different threads are submitted and waited for in parallel.
+// Throws std::system_error when the kernel refuses to set up a ring.
+class UringDisk : public FileDisk {
+  static constexpr unsigned QUEUE_DEPTH = 64;
+
+  struct Operation;
+  class Ring;
+
+  std::vector<std::unique_ptr<Ring>> idle_rings_;
+  std::mutex mutex_; // guards idle_rings_
+
+public:
+  explicit UringDisk(std::string const &path);
+  UringDisk(const UringDisk &) = delete;
+  UringDisk(UringDisk &&) = delete;
+
+  ~UringDisk() override;
+  auto operator=(const UringDisk &) -> UringDisk & = delete;
+  auto operator=(UringDisk &&) -> UringDisk & = delete;
+
+  [[nodiscard]] auto read_batch(std::vector<ReadRequest> const &requests)
+      -> std::vector<std::vector<std::byte>> override;
+  auto write_batch(std::vector<WriteRequest> const &requests) -> void override;
+
+private:
+  auto submit(std::vector<Operation> const &operations) -> std::vector<std::uint64_t>;
+  [[nodiscard]] auto acquire_ring() -> std::unique_ptr<Ring>;
+  auto release_ring(std::unique_ptr<Ring> ring) -> void;
+};
+
+#endif
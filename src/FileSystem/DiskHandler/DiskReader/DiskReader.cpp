@@ -1,28 +1,34 @@
 #include "DiskReader.hpp"
 
-DiskReader::DiskReader() : DiskHandler(0), is_(nullptr), block_size_(0) {}
+DiskReader::DiskReader() : DiskHandler(0), disk_(nullptr), block_size_(0) {}
+
+DiskReader::DiskReader(std::shared_ptr<Disk> disk, std::uint64_t offset, std::uint64_t block_size)
+    : DiskHandler(offset), disk_(std::move(disk)), block_size_(block_size) {}
 
 DiskReader::DiskReader(std::shared_ptr<std::istream> stream, std::uint64_t offset, std::uint64_t block_size)
-    : DiskHandler(offset), is_(std::move(stream)), block_size_(block_size) {}
+    : DiskReader(std::make_shared<StreamDisk>(std::move(stream), nullptr), offset, block_size) {}
 
 auto DiskReader::get_block_size() const noexcept -> std::uint64_t { return block_size_; }
 
 auto DiskReader::set_block_size(std::uint64_t block_size) noexcept -> void { block_size_ = block_size; }
 
-auto DiskReader::read() const -> std::vector<std::byte> {
-  is_->seekg(static_cast<std::streamoff>(get_offset() + get_handled_size()));
-
-  std::vector<std::byte> block;
-  block.reserve(get_block_size());
+auto DiskReader::set_io_stats(std::shared_ptr<IOStats> io_stats) noexcept -> void { io_stats_ = std::move(io_stats); }
 
-  std::istreambuf_iterator<char> iter(*is_);
-  std::istreambuf_iterator<char> end;
+auto DiskReader::read() const -> std::vector<std::byte> {
+  auto offset = get_offset() + get_handled_size();
+  auto block = disk_->read_at(offset, get_block_size());
+  if (io_stats_) io_stats_->record_read(offset, block.size());
+  return block;
+}
 
-  for (std::size_t i = 0; i < get_block_size() && iter != end; ++i, ++iter) {
-    block.push_back(static_cast<std::byte>(*iter));
+auto DiskReader::read_batch(std::vector<Disk::ReadRequest> const &requests) const
+    -> std::vector<std::vector<std::byte>> {
+  // requests carry absolute offsets, the reader's own position is left alone
+  auto blocks = disk_->read_batch(requests);
+  if (io_stats_) {
+    for (std::size_t i = 0; i < requests.size(); ++i) io_stats_->record_read(requests[i].offset, blocks[i].size());
   }
-
-  return block;
+  return blocks;
 }
 
 auto DiskReader::read_next() -> std::vector<std::byte> {
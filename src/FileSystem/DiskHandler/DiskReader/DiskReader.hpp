@@ -1,17 +1,21 @@
 #pragma once
 
+#include "../Disk/StreamDisk/StreamDisk.hpp"
 #include "../DiskHandler.hpp"
+#include "../../IOStats/IOStats.hpp"
 #include <fstream>
 #include <memory>
 #include <utility>
 #include <vector>
 
 class DiskReader : public DiskHandler {
-  std::shared_ptr<std::istream> is_;
+  std::shared_ptr<Disk> disk_;
   std::uint64_t block_size_;
+  std::shared_ptr<IOStats> io_stats_;
 
 public:
   DiskReader();
+  DiskReader(std::shared_ptr<Disk> disk, std::uint64_t offset, std::uint64_t block_size);
   DiskReader(std::shared_ptr<std::istream> stream, std::uint64_t offset, std::uint64_t block_size);
   DiskReader(const DiskReader &disk_reader) = default;
 
@@ -22,7 +26,10 @@ public:
 
   [[nodiscard]] auto get_block_size() const noexcept -> std::uint64_t;
   auto set_block_size(std::uint64_t block_size) noexcept -> void;
+  auto set_io_stats(std::shared_ptr<IOStats> io_stats) noexcept -> void;
 
   [[nodiscard]] auto read() const -> std::vector<std::byte>;
   auto read_next() -> std::vector<std::byte>;
+  [[nodiscard]] auto read_batch(std::vector<Disk::ReadRequest> const &requests) const
+      -> std::vector<std::vector<std::byte>>;
 };
\ No newline at end of file
@@ -1,15 +1,27 @@
 #include "DiskWriter.hpp"
 
-DiskWriter::DiskWriter() : DiskHandler(0), os_(nullptr) {}
+DiskWriter::DiskWriter() : DiskHandler(0), disk_(nullptr) {}
+
+DiskWriter::DiskWriter(std::shared_ptr<Disk> disk, std::uint64_t offset)
+    : DiskHandler(offset), disk_(std::move(disk)) {}
 
 DiskWriter::DiskWriter(std::shared_ptr<std::ostream> stream, std::uint64_t offset)
-    : DiskHandler(offset), os_(std::move(stream)) {}
+    : DiskWriter(std::make_shared<StreamDisk>(nullptr, std::move(stream)), offset) {}
+
+auto DiskWriter::set_io_stats(std::shared_ptr<IOStats> io_stats) noexcept -> void { io_stats_ = std::move(io_stats); }
 
 auto DiskWriter::write(const std::vector<std::byte> &bytes) const -> void {
-  os_->seekp(static_cast<std::streamoff>(get_offset() + get_handled_size()));
-  os_->write(reinterpret_cast<const char *>(bytes.data()), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-             static_cast<std::streamsize>(bytes.size()));
-  os_->flush();
+  auto offset = get_offset() + get_handled_size();
+  disk_->write_at(offset, bytes);
+  if (io_stats_) io_stats_->record_write(offset, bytes.size());
+}
+
+auto DiskWriter::write_batch(std::vector<Disk::WriteRequest> const &requests) const -> void {
+  // requests carry absolute offsets, the writer's own position is left alone
+  disk_->write_batch(requests);
+  if (io_stats_) {
+    for (auto const &request : requests) io_stats_->record_write(request.offset, request.bytes.size());
+  }
 }
 
 auto DiskWriter::write_next(const std::vector<std::byte> &bytes) -> void {
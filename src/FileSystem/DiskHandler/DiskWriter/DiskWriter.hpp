@@ -1,16 +1,20 @@
 #pragma once
 
+#include "../Disk/StreamDisk/StreamDisk.hpp"
 #include "../DiskHandler.hpp"
+#include "../../IOStats/IOStats.hpp"
 #include <fstream>
 #include <memory>
 #include <utility>
 #include <vector>
 
 class DiskWriter : public DiskHandler {
-  std::shared_ptr<std::ostream> os_;
+  std::shared_ptr<Disk> disk_;
+  std::shared_ptr<IOStats> io_stats_;
 
 public:
   DiskWriter();
+  DiskWriter(std::shared_ptr<Disk> disk, std::uint64_t offset);
   DiskWriter(std::shared_ptr<std::ostream> stream, std::uint64_t offset);
   DiskWriter(const DiskWriter &disk_writer) = default;
 
@@ -19,6 +23,9 @@ public:
   DiskWriter(DiskWriter &&other) = default;
   auto operator=(DiskWriter &&other) -> DiskWriter & = default;
 
+  auto set_io_stats(std::shared_ptr<IOStats> io_stats) noexcept -> void;
+
   auto write(const std::vector<std::byte> &bytes) const -> void;
   auto write_next(const std::vector<std::byte> &bytes) -> void;
+  auto write_batch(std::vector<Disk::WriteRequest> const &requests) const -> void;
 };
\ No newline at end of file
@@ -1,10 +1,12 @@
 #include "FAT.hpp"
 
-FAT::FAT() : entries_count_(0), disk_offset_(0) {}
+FAT::FAT()
+    : entries_count_(0), disk_offset_(0), refcounts_offset_(0), mutex_(std::make_shared<std::recursive_mutex>()) {}
 
 FAT::FAT(DiskReader disk_reader_, DiskWriter disk_writer_, std::uint64_t offset, std::uint64_t entries_count)
-    : entries_count_(entries_count), disk_offset_(offset), disk_reader_(std::move(disk_reader_)),
-      disk_writer_(std::move(disk_writer_)) {}
+    : entries_count_(entries_count), disk_offset_(offset), refcounts_offset_(offset + entries_count * ENTRY_SIZE),
+      disk_reader_(std::move(disk_reader_)), disk_writer_(std::move(disk_writer_)),
+      mutex_(std::make_shared<std::recursive_mutex>()) {}
 
 auto FAT::get_clusters_count() const noexcept -> std::uint64_t { return entries_count_; }
 
@@ -33,19 +35,14 @@ auto FAT::get_entries() -> std::vector<FATEntry> {
 }
 
 auto FAT::allocate() -> std::uint64_t {
-  for (std::uint64_t i = 0; i < entries_count_; ++i) {
-    if (!is_allocated(i)) {
-      auto entry = FATEntry{ClusterStatusOptions::LAST, 0};
-      disk_writer_.set_offset(disk_offset_ + i * ENTRY_SIZE);
-      disk_writer_.write(to_bytes(entry));
-      return i;
-    }
-  }
-
-  throw std::runtime_error("Cannot allocate cluster");
+  std::lock_guard<std::recursive_mutex> lock(*mutex_);
+  auto cluster_index = find_free_clusters(1).front();
+  set_entry(cluster_index, FATEntry{ClusterStatusOptions::LAST, 0});
+  return cluster_index;
 }
 
 auto FAT::allocate_next(std::uint64_t cluster_index) -> std::uint64_t {
+  std::lock_guard<std::recursive_mutex> lock(*mutex_);
   if (cluster_index >= entries_count_) { throw std::invalid_argument("Invalid cluster index"); }
 
   auto entry = get_entry(cluster_index);
@@ -57,27 +54,74 @@ auto FAT::allocate_next(std::uint64_t cluster_index) -> std::uint64_t {
   return next_cluster_index;
 }
 
+auto FAT::allocate_chain(std::uint64_t count) -> std::vector<std::uint64_t> {
+  std::lock_guard<std::recursive_mutex> lock(*mutex_);
+  if (count == 0) throw std::invalid_argument("Cannot allocate empty chain");
+
+  auto clusters = find_free_clusters(count);
+
+  // link the chain, writing each physically contiguous run of entries at once
+  std::size_t run_start = 0;
+  std::vector<FATEntry> run;
+  for (std::size_t i = 0; i < clusters.size(); ++i) {
+    if (i + 1 < clusters.size()) {
+      run.push_back(FATEntry{ClusterStatusOptions::ALLOCATED, clusters[i + 1]});
+    } else {
+      run.push_back(FATEntry{ClusterStatusOptions::LAST, 0});
+    }
+
+    if (i + 1 == clusters.size() || clusters[i + 1] != clusters[i] + 1) {
+      write_entries(clusters[run_start], run);
+      run.clear();
+      run_start = i + 1;
+    }
+  }
+
+  return clusters;
+}
+
 auto FAT::free(std::uint64_t cluster_index) -> void {
+  std::lock_guard<std::recursive_mutex> lock(*mutex_);
   if (cluster_index >= entries_count_) { throw std::invalid_argument("Invalid cluster index"); }
 
   auto entry = get_entry(cluster_index);
-  while (entry.status != ClusterStatusOptions::LAST) {
+  while (true) {
     if (entry.status == ClusterStatusOptions::FREE) throw std::runtime_error("Cannot free unallocated cluster");
 
+    // a shared cluster keeps the rest of the chain alive for its other owners
+    auto extra_references = get_extra_references(cluster_index);
+    if (extra_references > 0) {
+      set_extra_references(cluster_index, extra_references - 1);
+      return;
+    }
+
+    auto is_last_entry = entry.status == ClusterStatusOptions::LAST;
     auto next_cluster_index = entry.next_cluster;
     entry.status = ClusterStatusOptions::FREE;
     entry.next_cluster = 0;
     set_entry(cluster_index, entry);
+    if (is_last_entry) return;
+
     cluster_index = next_cluster_index;
     entry = get_entry(cluster_index);
   }
+}
 
-  entry.status = ClusterStatusOptions::FREE;
-  entry.next_cluster = 0;
-  set_entry(cluster_index, entry);
+auto FAT::share(std::uint64_t cluster_index) -> void {
+  std::lock_guard<std::recursive_mutex> lock(*mutex_);
+  if (!is_allocated(cluster_index)) throw std::runtime_error("Cluster is not allocated");
+  set_extra_references(cluster_index, get_extra_references(cluster_index) + 1);
+}
+
+auto FAT::is_shared(std::uint64_t cluster_index) -> bool { return get_extra_references(cluster_index) > 0; }
+
+auto FAT::get_references_count(std::uint64_t cluster_index) -> std::uint64_t {
+  if (!is_allocated(cluster_index)) return 0;
+  return get_extra_references(cluster_index) + 1;
 }
 
 auto FAT::shrink(std::uint64_t cluster_index) -> void {
+  std::lock_guard<std::recursive_mutex> lock(*mutex_);
   auto entry = get_entry(cluster_index);
   if (entry.status != ClusterStatusOptions::LAST) free(get_next(cluster_index));
   entry.status = ClusterStatusOptions::LAST;
@@ -86,6 +130,7 @@ auto FAT::shrink(std::uint64_t cluster_index) -> void {
 }
 
 auto FAT::set_next(std::uint64_t cluster_index, std::uint64_t next_cluster_index) -> void {
+  std::lock_guard<std::recursive_mutex> lock(*mutex_);
   if (cluster_index >= entries_count_ || next_cluster_index >= entries_count_) {
     throw std::runtime_error("Invalid cluster index");
   }
@@ -99,6 +144,19 @@ auto FAT::set_next(std::uint64_t cluster_index, std::uint64_t next_cluster_index
   set_entry(cluster_index, entry);
 }
 
+auto FAT::replace_next(std::uint64_t cluster_index, std::uint64_t next_cluster_index) -> void {
+  std::lock_guard<std::recursive_mutex> lock(*mutex_);
+  if (cluster_index >= entries_count_ || next_cluster_index >= entries_count_) {
+    throw std::runtime_error("Invalid cluster index");
+  }
+
+  auto entry = get_entry(cluster_index);
+  if (entry.status != ClusterStatusOptions::ALLOCATED) throw std::runtime_error("Cluster has no next cluster");
+
+  entry.next_cluster = next_cluster_index;
+  set_entry(cluster_index, entry);
+}
+
 auto FAT::get_next(std::uint64_t cluster_index) -> std::uint64_t {
   auto entry = get_entry(cluster_index);
   if (entry.status == ClusterStatusOptions::FREE) throw std::runtime_error("Cluster is not allocated");
@@ -106,6 +164,26 @@ auto FAT::get_next(std::uint64_t cluster_index) -> std::uint64_t {
   return entry.next_cluster;
 }
 
+auto FAT::get_chain(std::uint64_t first_cluster_index, std::uint64_t count) -> std::vector<std::uint64_t> {
+  std::vector<FATEntry> window;
+  std::uint64_t window_start = 0;
+  return walk_chain(first_cluster_index, count, window, window_start);
+}
+
+auto FAT::get_chains(std::vector<std::uint64_t> const &first_cluster_indices, std::uint64_t count)
+    -> std::vector<std::vector<std::uint64_t>> {
+  // the chains share one window, chains that start close together are served by the same read
+  std::vector<FATEntry> window;
+  std::uint64_t window_start = 0;
+
+  std::vector<std::vector<std::uint64_t>> chains;
+  chains.reserve(first_cluster_indices.size());
+  for (auto first_cluster_index : first_cluster_indices) {
+    chains.push_back(walk_chain(first_cluster_index, count, window, window_start));
+  }
+  return chains;
+}
+
 auto FAT::is_last(std::uint64_t cluster_index) -> bool {
   return get_entry(cluster_index).status == ClusterStatusOptions::LAST;
 }
@@ -134,6 +212,108 @@ auto FAT::set_entry(std::uint64_t cluster_index, FATEntry const &entry) -> void
   disk_writer_.write(to_bytes(entry));
 }
 
+auto FAT::get_extra_references(std::uint64_t cluster_index) -> std::uint64_t {
+  if (cluster_index >= entries_count_) throw std::runtime_error("Invalid cluster index");
+
+  disk_reader_.set_offset(refcounts_offset_ + cluster_index * REFCOUNT_SIZE);
+  disk_reader_.set_block_size(REFCOUNT_SIZE);
+  return Converter::to_uint64(disk_reader_.read());
+}
+
+auto FAT::set_extra_references(std::uint64_t cluster_index, std::uint64_t count) -> void {
+  if (cluster_index >= entries_count_) throw std::runtime_error("Invalid cluster index");
+
+  disk_writer_.set_offset(refcounts_offset_ + cluster_index * REFCOUNT_SIZE);
+  disk_writer_.write(Converter::to_bytes(count));
+}
+
+auto FAT::read_entries(std::uint64_t first_index, std::uint64_t count) -> std::vector<FATEntry> {
+  if (first_index + count > entries_count_) throw std::runtime_error("Invalid cluster index");
+
+  disk_reader_.set_offset(disk_offset_ + first_index * ENTRY_SIZE);
+  disk_reader_.set_block_size(count * ENTRY_SIZE);
+  auto bytes = disk_reader_.read();
+  if (bytes.size() != count * ENTRY_SIZE) throw std::runtime_error("Cannot read FAT entries");
+
+  std::vector<FATEntry> entries;
+  entries.reserve(count);
+  for (std::uint64_t i = 0; i < count; ++i) {
+    auto entry_begin = bytes.begin() + static_cast<std::int64_t>(i * ENTRY_SIZE);
+    entries.push_back(to_fat_entry(std::vector<std::byte>(entry_begin, entry_begin + ENTRY_SIZE)));
+  }
+
+  return entries;
+}
+
+auto FAT::write_entries(std::uint64_t first_index, std::vector<FATEntry> const &entries) -> void {
+  if (first_index + entries.size() > entries_count_) throw std::runtime_error("Invalid cluster index");
+
+  std::vector<std::byte> bytes;
+  bytes.reserve(entries.size() * ENTRY_SIZE);
+  for (auto const &entry : entries) {
+    auto entry_bytes = to_bytes(entry);
+    bytes.insert(bytes.end(), entry_bytes.begin(), entry_bytes.end());
+  }
+
+  disk_writer_.set_offset(disk_offset_ + first_index * ENTRY_SIZE);
+  disk_writer_.write(bytes);
+}
+
+auto FAT::find_free_clusters(std::uint64_t count) -> std::vector<std::uint64_t> {
+  // first fit for a contiguous run, falling back to the first free clusters found
+  std::vector<std::uint64_t> scattered;
+  std::uint64_t run_start = 0;
+  std::uint64_t run_length = 0;
+
+  for (std::uint64_t first = 0; first < entries_count_; first += ENTRIES_PER_SCAN) {
+    auto entries = read_entries(first, std::min(std::uint64_t{ENTRIES_PER_SCAN}, entries_count_ - first));
+    for (std::uint64_t i = 0; i < entries.size(); ++i) {
+      if (entries[i].status != ClusterStatusOptions::FREE) {
+        run_length = 0;
+        continue;
+      }
+
+      if (run_length == 0) run_start = first + i;
+      ++run_length;
+      if (scattered.size() < count) scattered.push_back(first + i);
+
+      if (run_length == count) {
+        std::vector<std::uint64_t> clusters(count);
+        for (std::uint64_t j = 0; j < count; ++j) clusters[j] = run_start + j;
+        return clusters;
+      }
+    }
+  }
+
+  if (scattered.size() < count) throw std::runtime_error("Cannot allocate cluster");
+  return scattered;
+}
+
+auto FAT::walk_chain(std::uint64_t first_cluster_index, std::uint64_t count, std::vector<FATEntry> &window,
+                     std::uint64_t &window_start) -> std::vector<std::uint64_t> {
+  // entries are read a window at a time, a contiguous chain costs one read per window instead of one per cluster
+  std::vector<std::uint64_t> chain;
+  chain.reserve(count);
+  if (count == 0) return chain;
+
+  auto cluster_index = first_cluster_index;
+  while (true) {
+    if (cluster_index >= entries_count_) throw std::runtime_error("Invalid cluster index");
+    if (cluster_index < window_start || cluster_index >= window_start + window.size()) {
+      window_start = cluster_index;
+      window = read_entries(cluster_index, std::min(std::uint64_t{CHAIN_WINDOW}, entries_count_ - cluster_index));
+    }
+
+    auto const &entry = window[cluster_index - window_start];
+    if (entry.status == ClusterStatusOptions::FREE) throw std::runtime_error("Cluster is not allocated");
+
+    chain.push_back(cluster_index);
+    if (chain.size() == count) return chain;
+    if (entry.status == ClusterStatusOptions::LAST) throw std::runtime_error("Chain is shorter than requested");
+    cluster_index = entry.next_cluster;
+  }
+}
+
 auto FAT::to_fat_entry(std::vector<std::byte> const &entry_bytes) -> FATEntry {
   if (entry_bytes.size() != ENTRY_SIZE) throw std::runtime_error("Invalid FAT entry size");
 
@@ -167,6 +347,8 @@ auto FAT::get_empty_entry_bytes() -> std::vector<std::byte> {
 
 auto FAT::get_entry_size() -> std::uint64_t { return ENTRY_SIZE; }
 
+auto FAT::get_refcount_size() -> std::uint64_t { return REFCOUNT_SIZE; }
+
 auto FAT::to_string(FAT const &fat) -> std::string {
   std::ostringstream oss;
 
@@ -3,6 +3,9 @@
 #include "../Converter/Converter.hpp"
 #include "../DiskHandler/DiskReader/DiskReader.hpp"
 #include "../DiskHandler/DiskWriter/DiskWriter.hpp"
+#include <algorithm>
+#include <memory>
+#include <mutex>
 #include <sstream>
 
 class FAT {
@@ -12,14 +15,21 @@ class FAT {
   static const std::uint64_t STATUS_SIZE = 1;
   static const std::uint64_t NEXT_CLUSTER_SIZE = 8;
   static const std::uint64_t ENTRY_SIZE = STATUS_SIZE + NEXT_CLUSTER_SIZE;
+  static const std::uint64_t REFCOUNT_SIZE = 8;
   static const std::uint64_t MAX_ENTRIES_TO_LOAD = 1000;
+  static const std::uint64_t ENTRIES_PER_SCAN = 4096;
+  static const std::uint64_t CHAIN_WINDOW = 512;
 
   std::uint64_t entries_count_;
   std::uint64_t disk_offset_;
+  std::uint64_t refcounts_offset_;
 
   DiskReader disk_reader_;
   DiskWriter disk_writer_;
 
+  // shared by every copy of the table, serializes allocation and chain updates
+  std::shared_ptr<std::recursive_mutex> mutex_;
+
 public:
   FAT();
   FAT(DiskReader disk_reader_, DiskWriter disk_writer_, std::uint64_t offset, std::uint64_t entries_count);
@@ -29,21 +39,37 @@ public:
 
   [[nodiscard]] auto allocate() -> std::uint64_t;
   [[nodiscard]] auto allocate_next(std::uint64_t cluster_index) -> std::uint64_t;
+  [[nodiscard]] auto allocate_chain(std::uint64_t count) -> std::vector<std::uint64_t>;
   auto free(std::uint64_t cluster_index) -> void;
+  auto share(std::uint64_t cluster_index) -> void;
+  [[nodiscard]] auto is_shared(std::uint64_t cluster_index) -> bool;
+  [[nodiscard]] auto get_references_count(std::uint64_t cluster_index) -> std::uint64_t;
   auto shrink(std::uint64_t cluster_index) -> void;
   auto set_next(std::uint64_t cluster_index, std::uint64_t next_cluster_index) -> void;
+  auto replace_next(std::uint64_t cluster_index, std::uint64_t next_cluster_index) -> void;
   [[nodiscard]] auto get_next(std::uint64_t cluster_index) -> std::uint64_t;
+  [[nodiscard]] auto get_chain(std::uint64_t first_cluster_index, std::uint64_t count) -> std::vector<std::uint64_t>;
+  [[nodiscard]] auto get_chains(std::vector<std::uint64_t> const &first_cluster_indices, std::uint64_t count)
+      -> std::vector<std::vector<std::uint64_t>>;
   [[nodiscard]] auto is_last(std::uint64_t cluster_index) -> bool;
   [[nodiscard]] auto is_allocated(std::uint64_t cluster_index) -> bool;
 
   static auto get_empty_entry_bytes() -> std::vector<std::byte>;
   static auto get_entry_size() -> std::uint64_t;
+  static auto get_refcount_size() -> std::uint64_t;
   static auto to_string(FAT const &fat) -> std::string;
 
 private:
   [[nodiscard]] auto get_entries() -> std::vector<FATEntry>;
   [[nodiscard]] auto get_entry(std::uint64_t cluster_index) -> FATEntry;
   auto set_entry(std::uint64_t cluster_index, FATEntry const &entry) -> void;
+  [[nodiscard]] auto get_extra_references(std::uint64_t cluster_index) -> std::uint64_t;
+  auto set_extra_references(std::uint64_t cluster_index, std::uint64_t count) -> void;
+  [[nodiscard]] auto read_entries(std::uint64_t first_index, std::uint64_t count) -> std::vector<FATEntry>;
+  auto walk_chain(std::uint64_t first_cluster_index, std::uint64_t count, std::vector<FATEntry> &window,
+                  std::uint64_t &window_start) -> std::vector<std::uint64_t>;
+  auto write_entries(std::uint64_t first_index, std::vector<FATEntry> const &entries) -> void;
+  [[nodiscard]] auto find_free_clusters(std::uint64_t count) -> std::vector<std::uint64_t>;
 
   static auto to_fat_entry(std::vector<std::byte> const &entry_bytes) -> FATEntry;
   static auto to_bytes(FATEntry const &entry) -> std::vector<std::byte>;
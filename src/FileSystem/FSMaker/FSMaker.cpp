@@ -20,6 +20,8 @@ auto FSMaker::get_settings_offset() -> std::uint64_t { return SETTINGS_OFFSET; }
 
 auto FSMaker::get_signature() -> std::string { return {SIGNATURE}; }
 
+auto FSMaker::get_legacy_signature() -> std::string { return {LEGACY_SIGNATURE}; }
+
 auto FSMaker::get_signature_size() -> std::uint64_t { return SIGNATURE_SIZE; }
 
 auto FSMaker::validate_settings(Settings const &settings, bool allow_big) -> void {
@@ -79,9 +81,10 @@ auto FSMaker::write_fat(DiskWriter &writer, Settings const &settings) -> void {
 }
 
 auto FSMaker::calculate_fat_entries_count(Settings const &settings) -> std::uint64_t {
-  return (settings.size - SETTINGS_SIZE) / (FAT::get_entry_size() + settings.cluster_size);
+  return (settings.size - SETTINGS_SIZE) / (FAT::get_entry_size() + FAT::get_refcount_size() + settings.cluster_size);
 }
 
 auto FSMaker::calculate_clusters_start_offset(Settings const &settings) -> std::uint64_t {
-  return get_fat_offset() + calculate_fat_entries_count(settings) * FAT::get_entry_size();
+  // the reference counts table follows the FAT and is zeroed by fill_zeros, zero meaning a single owner
+  return get_fat_offset() + calculate_fat_entries_count(settings) * (FAT::get_entry_size() + FAT::get_refcount_size());
 }
@@ -14,7 +14,9 @@ class FSMaker {
   static const std::uint64_t MIN_FS_SIZE = 16;
   static const std::uint64_t MIN_CLUSTER_SIZE = 8;
 
-  static constexpr const char *SIGNATURE = "FSysGregoryKogan";
+  // the version in the signature changes with the layout, images of an older layout are refused when opened
+  static constexpr const char *SIGNATURE = "FSysGregKogan-v2";
+  static constexpr const char *LEGACY_SIGNATURE = "FSysGregoryKogan"; // no reference counts table after the FAT
   static const std::uint64_t SIGNATURE_SIZE = 16;
   static const std::uint64_t SETTINGS_OFFSET = SIGNATURE_SIZE;
   static const std::uint64_t SETTINGS_SIZE = 16;
@@ -30,6 +32,7 @@ public:
   static auto get_fat_offset() -> std::uint64_t;
   static auto get_settings_offset() -> std::uint64_t;
   static auto get_signature() -> std::string;
+  static auto get_legacy_signature() -> std::string;
   static auto get_signature_size() -> std::uint64_t;
   static auto calculate_fat_entries_count(Settings const &settings) -> std::uint64_t;
   static auto calculate_clusters_start_offset(Settings const &settings) -> std::uint64_t;
@@ -4,21 +4,28 @@ ByteReader::ByteReader(ClusterReader cluster_reader, FAT fat, std::uint64_t clus
     : cluster_reader_(std::move(cluster_reader)), fat_(std::move(fat)), cluster_(cluster) {}
 
 auto ByteReader::read_bytes(std::uint64_t offset, std::uint64_t size) -> std::vector<std::byte> {
-  std::vector<std::byte> bytes;
-  bytes.reserve(size);
+  if (size == 0) return {};
+
+  auto cluster_size = cluster_reader_.get_cluster_size();
+  auto first_cluster_number = offset / cluster_size;
+  auto last_cluster_number = (offset + size - 1) / cluster_size;
 
-  auto cur_cluster = cluster_;
-  std::uint64_t file_position = 0;
+  // the chain is walked first so every cluster of the range can be requested in one batch,
+  // the disk merges physically adjacent clusters into a single vectored read
+  auto chain = fat_.get_chain(cluster_, last_cluster_number + 1);
+  auto clusters =
+      std::vector<std::uint64_t>(chain.begin() + static_cast<std::int64_t>(first_cluster_number), chain.end());
 
-  while (bytes.size() < size) {
-    auto cluster_bytes = cluster_reader_.read_cluster(cur_cluster);
-    for (auto byte : cluster_bytes) {
-      if (file_position >= offset) { bytes.push_back(byte); }
-      ++file_position;
-      if (bytes.size() >= size) { break; }
-    }
+  std::vector<std::byte> bytes;
+  bytes.reserve(size);
 
-    if (bytes.size() < size) { cur_cluster = fat_.get_next(cur_cluster); }
+  auto position = offset % cluster_size;
+  for (auto const &cluster_bytes : cluster_reader_.read_cluster_batch(clusters)) {
+    if (position >= cluster_bytes.size()) break; // end of the image
+    auto count = std::min<std::uint64_t>(cluster_bytes.size() - position, size - bytes.size());
+    bytes.insert(bytes.end(), cluster_bytes.begin() + static_cast<std::int64_t>(position),
+                 cluster_bytes.begin() + static_cast<std::int64_t>(position + count));
+    position = 0;
   }
 
   return bytes;
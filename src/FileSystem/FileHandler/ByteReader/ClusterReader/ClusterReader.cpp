@@ -1,14 +1,77 @@
 #include "ClusterReader.hpp"
 
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
 #include <utility>
 
 ClusterReader::ClusterReader(DiskReader disk_reader, std::uint64_t clusters_start_offset, std::uint64_t cluster_size)
     : disk_reader_(std::move(disk_reader)), clusters_start_offset_(clusters_start_offset), cluster_size_(cluster_size) {
 }
 
+auto ClusterReader::get_cluster_size() const -> std::uint64_t { return cluster_size_; }
+
 auto ClusterReader::read_cluster(std::uint64_t cluster_index) -> std::vector<std::byte> {
-  auto cluster_offset = clusters_start_offset_ + cluster_index * cluster_size_;
+  return read_clusters(cluster_index, 1);
+}
+
+auto ClusterReader::read_clusters(std::uint64_t first_cluster_index, std::uint64_t count) -> std::vector<std::byte> {
+  auto cluster_offset = clusters_start_offset_ + first_cluster_index * cluster_size_;
   disk_reader_.set_offset(cluster_offset);
-  disk_reader_.set_block_size(cluster_size_);
+  disk_reader_.set_block_size(count * cluster_size_);
   return disk_reader_.read();
 }
+
+auto ClusterReader::read_cluster_batch(std::vector<std::uint64_t> const &cluster_indices) const
+    -> std::vector<std::vector<std::byte>> {
+  std::vector<Disk::ReadRequest> requests;
+  requests.reserve(cluster_indices.size());
+  for (auto cluster_index : cluster_indices) {
+    requests.push_back({clusters_start_offset_ + cluster_index * cluster_size_, cluster_size_});
+  }
+  return disk_reader_.read_batch(requests);
+}
+
+auto ClusterReader::read_cluster_prefixes(std::vector<std::uint64_t> const &cluster_indices, std::uint64_t size) const
+    -> std::vector<std::vector<std::byte>> {
+  // clusters are visited in disk order and the ones lying close together are read as one span, so a scan over many
+  // small headers costs a few large reads instead of one seek each
+  std::vector<std::size_t> order(cluster_indices.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&cluster_indices](auto lhs, auto rhs) { return cluster_indices[lhs] < cluster_indices[rhs]; });
+
+  std::vector<Disk::ReadRequest> spans;
+  std::vector<std::size_t> span_of(cluster_indices.size());
+  for (auto index : order) {
+    auto offset = clusters_start_offset_ + cluster_indices[index] * cluster_size_;
+    if (!spans.empty()) {
+      auto &span = spans.back();
+      auto span_end = span.offset + span.size;
+      if (offset + size <= span_end) {
+        span_of[index] = spans.size() - 1;
+        continue;
+      }
+      if (offset <= span_end + MAX_SPAN_GAP && offset + size - span.offset <= MAX_SPAN_SIZE) {
+        span.size = offset + size - span.offset;
+        span_of[index] = spans.size() - 1;
+        continue;
+      }
+    }
+    spans.push_back({offset, size});
+    span_of[index] = spans.size() - 1;
+  }
+
+  auto blocks = disk_reader_.read_batch(spans);
+  std::vector<std::vector<std::byte>> prefixes;
+  prefixes.reserve(cluster_indices.size());
+  for (std::size_t i = 0; i < cluster_indices.size(); ++i) {
+    auto const &span = spans[span_of[i]];
+    auto const &block = blocks[span_of[i]];
+    auto begin = clusters_start_offset_ + cluster_indices[i] * cluster_size_ - span.offset;
+    if (begin + size > block.size()) throw std::runtime_error("Unexpected end of image");
+    prefixes.emplace_back(block.begin() + static_cast<std::int64_t>(begin),
+                          block.begin() + static_cast<std::int64_t>(begin + size));
+  }
+  return prefixes;
+}
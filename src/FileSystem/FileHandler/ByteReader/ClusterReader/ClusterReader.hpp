@@ -3,6 +3,9 @@
 #include "../../../DiskHandler/DiskReader/DiskReader.hpp"
 
 class ClusterReader {
+  static const std::uint64_t MAX_SPAN_GAP = 4096;
+  static const std::uint64_t MAX_SPAN_SIZE = 1 << 20;
+
   DiskReader disk_reader_;
   std::uint64_t clusters_start_offset_;
   std::uint64_t cluster_size_;
@@ -16,5 +19,12 @@ public:
   ClusterReader(ClusterReader &&other) = default;
   auto operator=(ClusterReader &&other) -> ClusterReader & = default;
 
+  [[nodiscard]] auto get_cluster_size() const -> std::uint64_t;
+
   [[nodiscard]] auto read_cluster(std::uint64_t cluster_index) -> std::vector<std::byte>;
+  [[nodiscard]] auto read_clusters(std::uint64_t first_cluster_index, std::uint64_t count) -> std::vector<std::byte>;
+  [[nodiscard]] auto read_cluster_batch(std::vector<std::uint64_t> const &cluster_indices) const
+      -> std::vector<std::vector<std::byte>>;
+  [[nodiscard]] auto read_cluster_prefixes(std::vector<std::uint64_t> const &cluster_indices,
+                                           std::uint64_t size) const -> std::vector<std::vector<std::byte>>;
 };
\ No newline at end of file
@@ -1,39 +1,73 @@
 #include "ByteWriter.hpp"
 
-ByteWriter::ByteWriter(ClusterWriter cluster_writer, FAT fat, std::uint64_t cluster)
-    : cluster_writer_(std::move(cluster_writer)), fat_(std::move(fat)), cluster_(cluster) {}
+ByteWriter::ByteWriter(ClusterReader cluster_reader, ClusterWriter cluster_writer, FAT fat, std::uint64_t cluster)
+    : cluster_reader_(std::move(cluster_reader)), cluster_writer_(std::move(cluster_writer)), fat_(std::move(fat)),
+      cluster_(cluster) {}
 
 auto ByteWriter::write_bytes(std::uint64_t offset, const std::vector<std::byte> &bytes) -> std::uint64_t {
-  auto cluster_number = offset / cluster_writer_.get_cluster_size();
-
-  auto cur_cluster = cluster_;
-  for (std::uint64_t i = 0; i < cluster_number; ++i) {
-    if (fat_.is_last(cur_cluster)) {
-      cur_cluster = fat_.allocate_next(cur_cluster);
-    } else {
-      cur_cluster = fat_.get_next(cur_cluster);
-    }
-  }
+  auto cluster_size = cluster_writer_.get_cluster_size();
+  auto first_cluster_number = offset / cluster_size;
+  auto last_cluster_number = bytes.empty() ? first_cluster_number : (offset + bytes.size() - 1) / cluster_size;
+
+  // the chain is extended first, then the data of every cluster goes out in one batch,
+  // the disk merges physically adjacent clusters into a single vectored write
+  auto chain = get_chain(last_cluster_number + 1);
 
+  std::vector<ClusterWriter::Write> writes;
   auto bytes_written = std::uint64_t{0};
-  auto position = offset % cluster_writer_.get_cluster_size();
-  auto bytes_to_write = bytes;
+  auto position = offset % cluster_size;
 
-  while (bytes_written < bytes.size()) {
-    auto bytes_written_in_cluster = cluster_writer_.write_at_position(cur_cluster, position, bytes_to_write);
-    bytes_written += bytes_written_in_cluster;
+  for (auto i = first_cluster_number; bytes_written < bytes.size(); ++i) {
+    auto count = std::min<std::uint64_t>(bytes.size() - bytes_written, cluster_size - position);
+    auto begin = bytes.begin() + static_cast<std::int64_t>(bytes_written);
+    writes.push_back({chain[i], position, std::vector<std::byte>(begin, begin + static_cast<std::int64_t>(count))});
+    bytes_written += count;
     position = 0;
-    bytes_to_write = std::vector<std::byte>(
-        bytes_to_write.begin() + static_cast<std::int64_t>(bytes_written_in_cluster), bytes_to_write.end());
-
-    if (bytes_written < bytes.size()) {
-      if (fat_.is_last(cur_cluster)) {
-        cur_cluster = fat_.allocate_next(cur_cluster);
-      } else {
-        cur_cluster = fat_.get_next(cur_cluster);
-      }
-    }
   }
 
+  cluster_writer_.write_batch(std::move(writes));
   return bytes_written + offset;
 }
+
+auto ByteWriter::get_chain(std::uint64_t count) -> std::vector<std::uint64_t> {
+  // existing clusters are walked one by one so shared ones get unshared, a missing tail is allocated as one chain
+  std::vector<std::uint64_t> chain{cluster_};
+  chain.reserve(count);
+
+  while (chain.size() < count) {
+    if (!fat_.is_last(chain.back())) {
+      chain.push_back(next_cluster(chain.back()));
+      continue;
+    }
+
+    auto tail = fat_.allocate_chain(count - chain.size());
+    fat_.set_next(chain.back(), tail.front());
+    chain.insert(chain.end(), tail.begin(), tail.end());
+  }
+
+  return chain;
+}
+
+auto ByteWriter::next_cluster(std::uint64_t cluster) -> std::uint64_t {
+  if (fat_.is_last(cluster)) return fat_.allocate_next(cluster);
+
+  auto next = fat_.get_next(cluster);
+  if (fat_.is_shared(next)) return unshare(cluster, next);
+  return next;
+}
+
+auto ByteWriter::unshare(std::uint64_t previous_cluster, std::uint64_t shared_cluster) -> std::uint64_t {
+  // copy on write: the private copy takes over the shared tail, which gains a reference through it
+  auto private_cluster = fat_.allocate();
+  cluster_writer_.write_cluster(private_cluster, cluster_reader_.read_cluster(shared_cluster));
+
+  if (!fat_.is_last(shared_cluster)) {
+    auto tail_cluster = fat_.get_next(shared_cluster);
+    fat_.share(tail_cluster);
+    fat_.set_next(private_cluster, tail_cluster);
+  }
+
+  fat_.replace_next(previous_cluster, private_cluster);
+  fat_.free(shared_cluster); // only drops this file's reference
+  return private_cluster;
+}
@@ -1,15 +1,17 @@
 #pragma once
 
 #include "../../FAT/FAT.hpp"
+#include "../ByteReader/ClusterReader/ClusterReader.hpp"
 #include "ClusterWriter/ClusterWriter.hpp"
 
 class ByteWriter {
+  ClusterReader cluster_reader_;
   ClusterWriter cluster_writer_;
   FAT fat_;
   std::uint64_t cluster_;
 
 public:
-  ByteWriter(ClusterWriter cluster_writer, FAT fat, std::uint64_t cluster);
+  ByteWriter(ClusterReader cluster_reader, ClusterWriter cluster_writer, FAT fat, std::uint64_t cluster);
   ByteWriter(const ByteWriter &byte_writer) = default;
 
   auto operator=(const ByteWriter &other) -> ByteWriter = delete;
@@ -18,4 +20,9 @@ public:
   ~ByteWriter() = default;
 
   auto write_bytes(std::uint64_t offset, const std::vector<std::byte> &bytes) -> std::uint64_t;
-};
\ No newline at end of file
+
+private:
+  [[nodiscard]] auto get_chain(std::uint64_t count) -> std::vector<std::uint64_t>;
+  [[nodiscard]] auto next_cluster(std::uint64_t cluster) -> std::uint64_t;
+  [[nodiscard]] auto unshare(std::uint64_t previous_cluster, std::uint64_t shared_cluster) -> std::uint64_t;
+};
@@ -1,5 +1,6 @@
 #include "ClusterWriter.hpp"
 
+#include <stdexcept>
 #include <utility>
 
 ClusterWriter::ClusterWriter(DiskWriter disk_writer, std::uint64_t clusters_start_offset, std::uint64_t cluster_size)
@@ -23,4 +24,23 @@ auto ClusterWriter::write_at_position(std::uint64_t cluster_index, std::uint64_t
 
 auto ClusterWriter::write_cluster(std::uint64_t cluster_index, const std::vector<std::byte> &bytes) -> std::uint64_t {
   return write_at_position(cluster_index, 0, bytes);
+}
+
+auto ClusterWriter::write_clusters(std::uint64_t first_cluster_index, const std::vector<std::byte> &bytes)
+    -> std::uint64_t {
+  auto cluster_offset = clusters_start_offset_ + first_cluster_index * cluster_size_;
+  disk_writer_.set_offset(cluster_offset);
+  disk_writer_.write(bytes);
+  return bytes.size();
+}
+
+auto ClusterWriter::write_batch(std::vector<Write> writes) -> void {
+  std::vector<Disk::WriteRequest> requests;
+  requests.reserve(writes.size());
+  for (auto &write : writes) {
+    if (write.position + write.bytes.size() > cluster_size_) throw std::invalid_argument("Write crosses cluster bound");
+    requests.push_back({clusters_start_offset_ + write.cluster_index * cluster_size_ + write.position,
+                        std::move(write.bytes)});
+  }
+  disk_writer_.write_batch(requests);
 }
\ No newline at end of file
@@ -8,6 +8,12 @@ class ClusterWriter {
   std::uint64_t cluster_size_;
 
 public:
+  struct Write {
+    std::uint64_t cluster_index;
+    std::uint64_t position;
+    std::vector<std::byte> bytes;
+  };
+
   ClusterWriter(DiskWriter disk_writer, std::uint64_t clusters_start_offset, std::uint64_t cluster_size);
   ClusterWriter(const ClusterWriter &cluster_writer) = default;
 
@@ -21,4 +27,6 @@ public:
   auto write_at_position(std::uint64_t cluster_index, std::uint64_t position, const std::vector<std::byte> &bytes)
       -> std::uint64_t;
   auto write_cluster(std::uint64_t cluster_index, const std::vector<std::byte> &bytes) -> std::uint64_t;
+  auto write_clusters(std::uint64_t first_cluster_index, const std::vector<std::byte> &bytes) -> std::uint64_t;
+  auto write_batch(std::vector<Write> writes) -> void;
 };
\ No newline at end of file
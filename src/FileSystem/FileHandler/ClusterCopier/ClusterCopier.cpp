@@ -0,0 +1,56 @@
+#include "ClusterCopier.hpp"
+
+ClusterCopier::ClusterCopier(ClusterReader cluster_reader, ClusterWriter cluster_writer, FAT fat)
+    : cluster_reader_(std::move(cluster_reader)), cluster_writer_(std::move(cluster_writer)), fat_(std::move(fat)) {}
+
+auto ClusterCopier::copy(std::uint64_t source_cluster, std::vector<std::uint64_t> const &destination_clusters)
+    -> void {
+  auto source_clusters = fat_.get_chain(source_cluster, destination_clusters.size());
+
+  auto cluster_size = cluster_reader_.get_cluster_size();
+  auto batch_clusters = std::max(std::uint64_t{1}, MAX_BATCH_SIZE / cluster_size);
+
+  for (std::size_t batch_begin = 0; batch_begin < source_clusters.size(); batch_begin += batch_clusters) {
+    auto batch_end = std::min(source_clusters.size(), batch_begin + batch_clusters);
+
+    std::vector<std::byte> buffer;
+    buffer.reserve((batch_end - batch_begin) * cluster_size);
+    for (auto const &run : get_runs(source_clusters, batch_begin, batch_end)) {
+      auto bytes = cluster_reader_.read_clusters(run.first_cluster, run.count);
+      bytes.resize(run.count * cluster_size, std::byte{0}); // the last cluster may overhang the image
+      buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+    }
+
+    auto buffer_offset = std::int64_t{0};
+    for (auto const &run : get_runs(destination_clusters, batch_begin, batch_end)) {
+      auto run_size = static_cast<std::int64_t>(run.count * cluster_size);
+      auto run_begin = buffer.begin() + buffer_offset;
+      cluster_writer_.write_clusters(run.first_cluster, std::vector<std::byte>(run_begin, run_begin + run_size));
+      buffer_offset += run_size;
+    }
+  }
+}
+
+auto ClusterCopier::clone(std::uint64_t source_cluster, std::uint64_t destination_cluster) -> void {
+  // the first cluster holds the header, so only the rest of the chain can be shared
+  copy(source_cluster, {destination_cluster});
+  if (fat_.is_last(source_cluster)) return;
+
+  auto tail_cluster = fat_.get_next(source_cluster);
+  fat_.share(tail_cluster);
+  fat_.set_next(destination_cluster, tail_cluster);
+}
+
+auto ClusterCopier::get_runs(std::vector<std::uint64_t> const &clusters, std::size_t begin, std::size_t end)
+    -> std::vector<Run> {
+  std::vector<Run> runs;
+  for (auto i = begin; i < end; ++i) {
+    if (!runs.empty() && runs.back().first_cluster + runs.back().count == clusters[i]) {
+      ++runs.back().count;
+    } else {
+      runs.push_back(Run{clusters[i], 1});
+    }
+  }
+  return runs;
+}
+
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../../FAT/FAT.hpp"
+#include "../ByteReader/ClusterReader/ClusterReader.hpp"
+#include "../ByteWriter/ClusterWriter/ClusterWriter.hpp"
+#include <utility>
+
+class ClusterCopier {
+  static const std::uint64_t MAX_BATCH_SIZE = 1048576; // 1 MiB
+
+  ClusterReader cluster_reader_;
+  ClusterWriter cluster_writer_;
+  FAT fat_;
+
+public:
+  struct Run {
+    std::uint64_t first_cluster;
+    std::uint64_t count;
+  };
+
+  ClusterCopier(ClusterReader cluster_reader, ClusterWriter cluster_writer, FAT fat);
+
+  auto copy(std::uint64_t source_cluster, std::vector<std::uint64_t> const &destination_clusters) -> void;
+  auto clone(std::uint64_t source_cluster, std::uint64_t destination_cluster) -> void;
+
+  [[nodiscard]] static auto get_runs(std::vector<std::uint64_t> const &clusters, std::size_t begin, std::size_t end)
+      -> std::vector<Run>;
+};
@@ -8,18 +8,70 @@ auto FileReader::get_block_size() const noexcept -> std::uint64_t { return block
 
 auto FileReader::set_block_size(std::uint64_t block_size) noexcept -> void { block_size_ = block_size; }
 
+auto FileReader::get_max_readahead() const noexcept -> std::uint64_t { return max_readahead_; }
+
+auto FileReader::set_max_readahead(std::uint64_t max_readahead) noexcept -> void {
+  max_readahead_ = max_readahead;
+  readahead_window_ = std::min(readahead_window_, max_readahead_);
+  readahead_buffer_.clear();
+}
+
+auto FileReader::get_readahead_window() const noexcept -> std::uint64_t { return readahead_window_; }
+
+auto FileReader::get_readahead_stats() const noexcept -> ReadaheadStats const & { return readahead_stats_; }
+
 auto FileReader::read() -> std::vector<std::byte> {
-  auto meta = get_metadata_handler().read_metadata();
+  auto position = get_offset() + get_handled_size();
+
+  // a full block inside the buffer is served without rereading the metadata
+  if (max_readahead_ > 0 && is_buffered(position, block_size_)) return take_buffered(position, block_size_);
 
-  auto size = std::min(block_size_, meta.get_size() - get_offset() - get_handled_size());
-  auto offset = Metadata::get_metadata_size() + get_offset() + get_handled_size();
+  auto meta = get_metadata_handler().read_metadata();
+  auto size = std::min(block_size_, meta.get_size() - position);
 
   if (size == 0) { return {}; }
-  return byte_reader_.read_bytes(offset, size);
+  if (max_readahead_ == 0) return byte_reader_.read_bytes(Metadata::get_metadata_size() + position, size);
+  if (meta.get_size() == readahead_file_size_ && is_buffered(position, size)) return take_buffered(position, size);
+  return read_ahead(position, size, meta.get_size());
 }
 
 auto FileReader::read_next() -> std::vector<std::byte> {
   auto block = read();
   increase_handled_size(block.size());
   return block;
-}
\ No newline at end of file
+}
+
+auto FileReader::is_buffered(std::uint64_t position, std::uint64_t size) const noexcept -> bool {
+  // only a sequential continuation is served from the buffer, jumping back always rereads the disk
+  return position == next_sequential_offset_ && position >= readahead_offset_ &&
+         position + size <= readahead_offset_ + readahead_buffer_.size();
+}
+
+auto FileReader::take_buffered(std::uint64_t position, std::uint64_t size) -> std::vector<std::byte> {
+  ++readahead_stats_.hits;
+  next_sequential_offset_ = position + size;
+  auto begin = readahead_buffer_.begin() + static_cast<std::int64_t>(position - readahead_offset_);
+  return {begin, begin + static_cast<std::int64_t>(size)};
+}
+
+auto FileReader::read_ahead(std::uint64_t position, std::uint64_t size, std::uint64_t file_size)
+    -> std::vector<std::byte> {
+  ++readahead_stats_.misses;
+  if (position == next_sequential_offset_) {
+    readahead_window_ = std::min(std::max(readahead_window_ * 2, size * INITIAL_WINDOW_FACTOR), max_readahead_);
+  } else {
+    readahead_window_ = 0;
+  }
+  next_sequential_offset_ = position + size;
+
+  // the block and the window behind it come in as one read
+  auto fetch_size = std::min(std::max(size, readahead_window_), file_size - position);
+  readahead_buffer_ = byte_reader_.read_bytes(Metadata::get_metadata_size() + position, fetch_size);
+  readahead_offset_ = position;
+  readahead_file_size_ = file_size;
+  readahead_stats_.prefetched_bytes +=
+      readahead_buffer_.size() - std::min<std::uint64_t>(size, readahead_buffer_.size());
+
+  if (readahead_buffer_.size() <= size) return readahead_buffer_;
+  return {readahead_buffer_.begin(), readahead_buffer_.begin() + static_cast<std::int64_t>(size)};
+}
@@ -2,17 +2,52 @@
 
 #include "../ByteReader/ByteReader.hpp"
 #include "../FileHandler.hpp"
+#include <algorithm>
 
+// Sequential reads are served from a readahead buffer whose window doubles on every sequential miss, up to the
+// maximum, and collapses on random access, much like the page cache readahead in Linux.
+// Full blocks inside the buffer are served without rereading the metadata, so size changes and overwrites made
+// through other handles only show up once the reader leaves the prefetched range.
 class FileReader : public FileHandler {
+public:
+  struct ReadaheadStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t prefetched_bytes = 0;
+  };
+
+private:
+  static const std::uint64_t DEFAULT_MAX_READAHEAD = 1048576; // 1 MiB
+  static const std::uint64_t INITIAL_WINDOW_FACTOR = 4;
+
   ByteReader byte_reader_;
   std::uint64_t block_size_;
 
+  std::vector<std::byte> readahead_buffer_;
+  std::uint64_t readahead_offset_ = 0;
+  std::uint64_t readahead_file_size_ = 0;
+  std::uint64_t readahead_window_ = 0;
+  std::uint64_t max_readahead_ = DEFAULT_MAX_READAHEAD;
+  std::uint64_t next_sequential_offset_ = 0;
+  ReadaheadStats readahead_stats_;
+
 public:
   FileReader(ByteReader byte_reader, MetadataHandler metadata_handler, std::uint64_t offset, std::uint64_t block_size);
 
   [[nodiscard]] auto get_block_size() const noexcept -> std::uint64_t;
   auto set_block_size(std::uint64_t block_size) noexcept -> void;
 
+  [[nodiscard]] auto get_max_readahead() const noexcept -> std::uint64_t;
+  auto set_max_readahead(std::uint64_t max_readahead) noexcept -> void; // 0 disables readahead
+  [[nodiscard]] auto get_readahead_window() const noexcept -> std::uint64_t;
+  [[nodiscard]] auto get_readahead_stats() const noexcept -> ReadaheadStats const &;
+
   [[nodiscard]] auto read() -> std::vector<std::byte>;
   auto read_next() -> std::vector<std::byte>;
-};
\ No newline at end of file
+
+private:
+  [[nodiscard]] auto is_buffered(std::uint64_t position, std::uint64_t size) const noexcept -> bool;
+  [[nodiscard]] auto take_buffered(std::uint64_t position, std::uint64_t size) -> std::vector<std::byte>;
+  [[nodiscard]] auto read_ahead(std::uint64_t position, std::uint64_t size, std::uint64_t file_size)
+      -> std::vector<std::byte>;
+};
@@ -12,7 +12,7 @@ auto HandlerBuilder::build_byte_reader(std::uint64_t cluster) const -> ByteReade
 }
 
 auto HandlerBuilder::build_byte_writer(std::uint64_t cluster) const -> ByteWriter {
-  return {cluster_writer_, fat_, cluster};
+  return {cluster_reader_, cluster_writer_, fat_, cluster};
 }
 
 auto HandlerBuilder::build_metadata_handler(std::uint64_t cluster) const -> MetadataHandler {
@@ -26,3 +26,44 @@ auto HandlerBuilder::build_file_reader(std::uint64_t cluster) const -> FileReade
 auto HandlerBuilder::build_file_writer(std::uint64_t cluster) const -> FileWriter {
   return {build_byte_writer(cluster), build_metadata_handler(cluster), 0};
 }
+
+auto HandlerBuilder::build_cluster_writer() const -> ClusterWriter { return cluster_writer_; }
+
+auto HandlerBuilder::build_cluster_copier() const -> ClusterCopier { return {cluster_reader_, cluster_writer_, fat_}; }
+
+auto HandlerBuilder::read_metadata_batch(std::vector<std::uint64_t> const &clusters) const -> std::vector<Metadata> {
+  std::vector<Metadata> metadata_list;
+  metadata_list.reserve(clusters.size());
+
+  auto header_size = Metadata::get_metadata_size();
+  auto cluster_size = cluster_reader_.get_cluster_size();
+  if (cluster_size >= header_size) {
+    // every header sits at the start of its first cluster, so they are all read in one pass without touching the FAT
+    for (auto const &bytes : cluster_reader_.read_cluster_prefixes(clusters, header_size)) {
+      metadata_list.push_back(Metadata::from_bytes(bytes));
+    }
+    return metadata_list;
+  }
+
+  // a header spanning several clusters follows its chain, the chains are resolved first and read together
+  auto header_clusters_count = (header_size + cluster_size - 1) / cluster_size;
+  auto fat = fat_;
+  auto chains = fat.get_chains(clusters, header_clusters_count);
+
+  std::vector<std::uint64_t> chain_clusters;
+  chain_clusters.reserve(clusters.size() * header_clusters_count);
+  for (auto const &chain : chains) chain_clusters.insert(chain_clusters.end(), chain.begin(), chain.end());
+  auto blocks = cluster_reader_.read_cluster_prefixes(chain_clusters, cluster_size);
+
+  for (std::size_t i = 0; i < chains.size(); ++i) {
+    std::vector<std::byte> bytes;
+    bytes.reserve(header_clusters_count * cluster_size);
+    for (std::uint64_t j = 0; j < header_clusters_count; ++j) {
+      auto const &block = blocks[i * header_clusters_count + j];
+      bytes.insert(bytes.end(), block.begin(), block.end());
+    }
+    bytes.resize(header_size);
+    metadata_list.push_back(Metadata::from_bytes(bytes));
+  }
+  return metadata_list;
+}
@@ -5,6 +5,7 @@
 #include "../../FAT/FAT.hpp"
 #include "../ByteReader/ClusterReader/ClusterReader.hpp"
 #include "../ByteWriter/ClusterWriter/ClusterWriter.hpp"
+#include "../ClusterCopier/ClusterCopier.hpp"
 #include "../FileReader/FileReader.hpp"
 #include "../FileWriter/FileWriter.hpp"
 #include "../MetadataHandler/MetadataHandler.hpp"
@@ -24,4 +25,8 @@ public:
   [[nodiscard]] auto build_metadata_handler(std::uint64_t cluster) const -> MetadataHandler;
   [[nodiscard]] auto build_file_reader(std::uint64_t cluster) const -> FileReader;
   [[nodiscard]] auto build_file_writer(std::uint64_t cluster) const -> FileWriter;
+  [[nodiscard]] auto build_cluster_writer() const -> ClusterWriter;
+  [[nodiscard]] auto build_cluster_copier() const -> ClusterCopier;
+
+  [[nodiscard]] auto read_metadata_batch(std::vector<std::uint64_t> const &clusters) const -> std::vector<Metadata>;
 };
\ No newline at end of file
@@ -1,16 +1,28 @@
 #include "FileSystem.hpp"
 
 FileSystem::FileSystem(std::string const &path) {
-  auto ifs = std::make_shared<std::ifstream>(path, std::ios::binary | std::ios::in);
-  auto ofs = std::make_shared<std::ofstream>(path, std::ios::binary | std::ios::out | std::ios::in);
-  if (!ifs->is_open() || !ofs->is_open()) throw std::runtime_error("Cannot open file " + path);
+  auto disk = open_disk(path);
+  disk_reader_ = DiskReader(disk, 0, 0);
 
-  disk_reader_ = DiskReader(std::move(ifs), 0, 0);
-  disk_writer_ = DiskWriter(std::move(ofs), 0);
-
-  if (!check_signature()) throw std::runtime_error("Specified file is not a file system");
+  auto signature = read_signature();
+  if (signature == FSMaker::get_legacy_signature()) {
+    throw std::runtime_error("Specified file system has an older layout without reference counts, recreate it");
+  }
+  if (signature != FSMaker::get_signature()) throw std::runtime_error("Specified file is not a file system");
   read_settings();
 
+  // small writes are combined per cluster before they reach the image, every handler shares the one layer
+  io_stats_ = std::make_shared<IOStats>(FSMaker::get_fat_offset(), FSMaker::calculate_clusters_start_offset(settings_));
+  disk_ = std::make_shared<CombiningDisk>(disk, settings_.cluster_size,
+                                          FSMaker::calculate_clusters_start_offset(settings_),
+                                          CombiningDisk::Limits{MAX_DIRTY_BYTES, MAX_DIRTY_AGE}, io_stats_);
+  disk_reader_ = DiskReader(disk_, 0, 0);
+  disk_reader_.set_io_stats(io_stats_);
+  disk_writer_ = DiskWriter(disk_, 0);
+  disk_writer_.set_io_stats(io_stats_);
+  writeback_ = std::make_shared<Writeback>(
+      disk_, Writeback::Thresholds{WRITEBACK_DIRTY_BYTES, WRITEBACK_AGE, WRITEBACK_INTERVAL});
+
   fat_ = FAT(disk_reader_, disk_writer_, FSMaker::get_fat_offset(), FSMaker::calculate_fat_entries_count(settings_));
 
   handler_builder_ = HandlerBuilder(disk_reader_, disk_writer_, fat_,
@@ -18,34 +30,182 @@ FileSystem::FileSystem(std::string const &path) {
 
   const std::string PATH_DELIMITER = "/";
   path_resolver_ = PathResolver(PATH_DELIMITER, handler_builder_);
+  tree_walker_ = TreeWalker(handler_builder_, inode_locks_);
 
   if (!is_root_dir_created()) create_root_dir();
   working_dir_cluster_ = 0;
 }
 
+auto FileSystem::open_disk(std::string const &path) -> std::shared_ptr<Disk> {
+#ifdef _WIN32
+  auto ifs = std::make_shared<std::ifstream>(path, std::ios::binary | std::ios::in);
+  auto ofs = std::make_shared<std::ofstream>(path, std::ios::binary | std::ios::out | std::ios::in);
+  if (!ifs->is_open() || !ofs->is_open()) throw std::runtime_error("Cannot open file " + path);
+  std::shared_ptr<Disk> disk = std::make_shared<StreamDisk>(std::move(ifs), std::move(ofs));
+#else
+  std::shared_ptr<Disk> disk;
+#ifdef FS_HAVE_IO_URING
+  try {
+    disk = std::make_shared<UringDisk>(path);
+  } catch (std::system_error const &) {} // no io_uring in this kernel or sandbox, batches fall back to pread/pwrite
+#endif
+  if (!disk) disk = std::make_shared<FileDisk>(path);
+#endif
+
+  return disk;
+}
+
+auto FileSystem::detach() const -> FileSystem {
+  // a queued operation works on its own copy, resolving relative paths against the working directory it was
+  // submitted from; the copy shares the image and the locks but not the executor, so a worker never owns its pool
+  std::shared_lock tree_lock(*tree_mutex_);
+  auto file_system = *this;
+  file_system.executor_ = nullptr;
+  return file_system;
+}
+
 auto FileSystem::make(std::string const &path, FSMaker::Settings const &settings, bool allow_big) -> void {
   FSMaker::make_fs(path, settings, allow_big);
 }
 
+auto FileSystem::sync() -> void {
+  if (disk_) disk_->flush();
+}
+
+auto FileSystem::drain() -> void {
+  // stops background writeback for every copy of this file system, later writes are flushed by the disk limits,
+  // sync() and destruction
+  if (writeback_) writeback_->drain();
+  sync();
+}
+
 auto FileSystem::get_settings() const noexcept -> FSMaker::Settings const & { return settings_; }
 
-auto FileSystem::pwd() const -> std::string { return path_resolver_.trace(working_dir_cluster_); }
+auto FileSystem::get_allocated_clusters_count() const -> std::uint64_t {
+  std::shared_lock tree_lock(*tree_mutex_);
+  auto fat = fat_;
+  return fat.get_allocated_clusters_count();
+}
+
+auto FileSystem::io_stats() const -> IOStats::Snapshot {
+  if (!io_stats_) return {};
+  return io_stats_->snapshot();
+}
+
+auto FileSystem::reset_io_stats() -> void {
+  if (io_stats_) io_stats_->reset();
+}
+
+auto FileSystem::get_phase_latencies() const noexcept -> PhaseLatencies const & { return *phase_latencies_; }
+
+auto FileSystem::reset_phase_latencies() -> void {
+  phase_latencies_->resolve.reset();
+  phase_latencies_->metadata.reset();
+  phase_latencies_->data.reset();
+}
+
+auto FileSystem::pwd() const -> std::string {
+  std::shared_lock tree_lock(*tree_mutex_);
+  return path_resolver_.trace(working_dir_cluster_);
+}
 
 auto FileSystem::ls(std::string const &path) const -> std::vector<Metadata> {
+  std::shared_lock tree_lock(*tree_mutex_);
   auto dir_cluster = search(path);
   if (!dir_cluster.has_value()) throw std::invalid_argument("Directory does not exist");
 
+  std::shared_lock dir_lock(inode_locks_->get(dir_cluster.value()));
   auto dir = read_dir(dir_cluster.value());
   auto child_clusters = dir.list_files();
   return get_metadata_from_clusters(child_clusters);
 }
 
+auto FileSystem::readdir(std::string const &path, bool names_only, std::size_t chunk_size) const -> DirCursor {
+  std::shared_lock tree_lock(*tree_mutex_);
+  auto dir_cluster = search(path);
+  if (!does_dir_exist(path) || !dir_cluster.has_value()) throw std::invalid_argument("Directory does not exist");
+
+  std::vector<std::uint64_t> child_clusters;
+  auto dir_meta = handler_builder_.build_metadata_handler(dir_cluster.value()).read_metadata();
+  {
+    std::shared_lock dir_lock(inode_locks_->get(dir_cluster.value()));
+    child_clusters = read_dir(dir_cluster.value()).list_files();
+  }
+
+  // the loader holds its own handles, so the cursor stays usable after the file system is moved
+  auto loader = [tree_mutex = tree_mutex_, inode_locks = inode_locks_, phase_latencies = phase_latencies_,
+                 handler_builder = handler_builder_, fat = fat_, dir_meta,
+                 names_only](std::vector<std::uint64_t> const &clusters) mutable {
+    auto dir = dir_meta.get_first_cluster();
+    std::shared_lock chunk_tree_lock(*tree_mutex);
+    std::shared_lock chunk_dir_lock(inode_locks->get(dir));
+    LatencyHistogram::Timer timer(phase_latencies->metadata);
+
+    // freed clusters keep their old bytes, so the directory and its listing are checked again before any header
+    // of the chunk is trusted; a directory removed in between yields nothing more
+    if (!fat.is_allocated(dir)) return std::vector<DirCursor::Entry>{};
+    auto current_meta = handler_builder.build_metadata_handler(dir).read_metadata();
+    if (!current_meta.is_directory() || current_meta.get_first_cluster() != dir ||
+        current_meta.get_parent_first_cluster() != dir_meta.get_parent_first_cluster() ||
+        current_meta.get_name() != dir_meta.get_name()) {
+      return std::vector<DirCursor::Entry>{};
+    }
+
+    auto listing_bytes = handler_builder.build_byte_reader(dir).read_bytes(Metadata::get_metadata_size(),
+                                                                           current_meta.get_size());
+    std::unordered_set<std::uint64_t> const chunk(clusters.begin(), clusters.end());
+    std::unordered_set<std::uint64_t> listed;
+    for (auto cluster : Directory::from_bytes(listing_bytes).list_files()) {
+      if (chunk.count(cluster) != 0) listed.insert(cluster);
+    }
+
+    std::vector<std::uint64_t> listed_clusters;
+    listed_clusters.reserve(listed.size());
+    std::copy_if(clusters.begin(), clusters.end(), std::back_inserter(listed_clusters),
+                 [&listed](auto cluster) { return listed.count(cluster) != 0; });
+
+    std::vector<DirCursor::Entry> entries;
+    entries.reserve(listed_clusters.size());
+    auto headers = handler_builder.read_metadata_batch(listed_clusters);
+    for (std::size_t i = 0; i < listed_clusters.size(); ++i) {
+      auto &meta = headers[i];
+      entries.push_back({meta.get_name(), listed_clusters[i], meta.is_directory(), std::nullopt});
+      if (!names_only) entries.back().metadata = std::move(meta);
+    }
+    return entries;
+  };
+  return {std::move(child_clusters), chunk_size, std::move(loader)};
+}
+
 auto FileSystem::stat(std::string const &path) const -> Metadata {
+  std::shared_lock tree_lock(*tree_mutex_);
   auto file_cluster = search(path);
   if (!file_cluster.has_value()) throw std::invalid_argument("File does not exist");
+
+  std::shared_lock file_lock(inode_locks_->get(file_cluster.value()));
+  LatencyHistogram::Timer timer(phase_latencies_->metadata);
   return handler_builder_.build_metadata_handler(file_cluster.value()).read_metadata();
 }
 
+auto FileSystem::du(std::string const &path) const -> DiskUsage {
+  std::shared_lock tree_lock(*tree_mutex_);
+  auto cluster = search(path);
+  if (!cluster.has_value()) throw std::invalid_argument("No such file or directory");
+
+  LatencyHistogram::Timer timer(phase_latencies_->metadata);
+  DiskUsage usage{0, 0, 0, 0};
+  tree_walker_.walk(cluster.value(), [&](Metadata const &meta) {
+    if (meta.is_directory()) {
+      ++usage.dirs_count;
+    } else {
+      ++usage.files_count;
+      usage.size += meta.get_size();
+    }
+    usage.clusters_count += calculate_clusters_count(meta.get_size());
+  });
+  return usage;
+}
+
 auto FileSystem::dirname(std::string const &path) const -> std::string {
   return PathResolver::dirname(path, path_resolver_.delimiter());
 }
@@ -55,6 +215,7 @@ auto FileSystem::basename(std::string const &path) const -> std::string {
 }
 
 auto FileSystem::get_reader(std::string const &path) const -> FileReader {
+  std::shared_lock tree_lock(*tree_mutex_);
   auto file_cluster = search(path);
   if (!file_cluster.has_value()) throw std::invalid_argument("File does not exist");
   if (handler_builder_.build_metadata_handler(file_cluster.value()).read_metadata().is_directory()) {
@@ -68,6 +229,7 @@ auto FileSystem::get_reader(std::string const &path) const -> FileReader {
 }
 
 auto FileSystem::get_writer(std::string const &path) -> FileWriter {
+  std::shared_lock tree_lock(*tree_mutex_);
   auto file_cluster = search(path);
   if (!file_cluster.has_value()) throw std::invalid_argument("File does not exist");
   if (handler_builder_.build_metadata_handler(file_cluster.value()).read_metadata().is_directory()) {
@@ -80,30 +242,87 @@ auto FileSystem::get_writer(std::string const &path) -> FileWriter {
 }
 
 auto FileSystem::mkdir(std::string const &path) -> void {
-  if (does_exist(path)) throw std::invalid_argument("Already exists");
+  std::unique_lock tree_lock(*tree_mutex_);
+  make_dir(path);
+}
+
+auto FileSystem::touch(std::string const &path) -> void {
+  std::unique_lock tree_lock(*tree_mutex_);
+  static_cast<void>(make_file(path));
+}
+
+auto FileSystem::rmdir(std::string const &path) -> void {
+  std::unique_lock tree_lock(*tree_mutex_);
+  remove_dir(path);
+}
+
+auto FileSystem::rm(std::string const &path, bool recursive) -> void {
+  std::unique_lock tree_lock(*tree_mutex_);
+  auto file_cluster = search(path);
+  if (!file_cluster.has_value()) throw std::invalid_argument("No such file or directory");
+
+  if (recursive) {
+    rm_recursive(path);
+    return;
+  }
+
+  if (handler_builder_.build_metadata_handler(file_cluster.value()).read_metadata().is_directory()) {
+    remove_dir(path);
+    return;
+  }
+
+  rmfile(path);
+}
+
+auto FileSystem::cp(std::string const &source, std::string const &destination, bool recursive, bool reflink,
+                    std::size_t threads) -> void {
+  std::unique_lock tree_lock(*tree_mutex_);
+  if (!recursive) {
+    shallow_copy(source, destination, reflink);
+    return;
+  }
+
+  deep_copy(source, destination, reflink, threads);
+}
+
+auto FileSystem::make_dir(std::string const &path) -> void {
   auto parent_dir_cluster = search(dirname(path));
   if (!parent_dir_cluster.has_value()) throw std::invalid_argument("Parent directory does not exist");
 
+  if (does_exist(path)) throw std::invalid_argument("Already exists");
+
   auto new_dir_cluster = alloc_new_dir(basename(path), parent_dir_cluster.value());
   add_file_to_dir(parent_dir_cluster.value(), new_dir_cluster);
 }
 
-auto FileSystem::touch(std::string const &path) -> void {
-  if (does_file_exist(path)) return;
+auto FileSystem::make_file(std::string const &path) -> std::optional<std::uint64_t> {
   auto parent_dir_cluster = search(dirname(path));
   if (!does_dir_exist(dirname(path)) || !parent_dir_cluster.has_value()) {
     throw std::invalid_argument("Parent directory does not exist");
   }
 
+  if (does_file_exist(path)) return {};
+
   auto new_file_cluster = fat_.allocate();
   auto new_file_byte_writer = handler_builder_.build_byte_writer(new_file_cluster);
   auto new_file_meta = Metadata(basename(path), 0, new_file_cluster, parent_dir_cluster.value(), false);
   new_file_byte_writer.write_bytes(0, new_file_meta.to_bytes());
 
   add_file_to_dir(parent_dir_cluster.value(), new_file_cluster);
+  return new_file_cluster;
 }
 
-auto FileSystem::rmdir(std::string const &path) -> void {
+auto FileSystem::make_import_target(std::string const &path) -> std::uint64_t {
+  // the listing is rewritten under the exclusive lock, the data is written afterwards under the file lock alone
+  std::unique_lock tree_lock(*tree_mutex_);
+  if (does_dir_exist(path)) throw std::invalid_argument("Cannot import nameless file to directory");
+
+  auto file_cluster = make_file(path);
+  if (!file_cluster.has_value()) throw std::invalid_argument("File already exists");
+  return file_cluster.value();
+}
+
+auto FileSystem::remove_dir(std::string const &path) -> void {
   auto dir_cluster = search(path);
   if (!does_dir_exist(path) || !dir_cluster.has_value()) throw std::invalid_argument("Directory does not exist");
   if (dir_cluster.value() == 0) throw std::invalid_argument("Cannot remove root directory");
@@ -117,45 +336,49 @@ auto FileSystem::rmdir(std::string const &path) -> void {
   remove_file_from_dir(parent_dir_cluster, dir_cluster.value());
 }
 
-auto FileSystem::rm(std::string const &path, bool recursive) -> void {
-  auto file_cluster = search(path);
-  if (!file_cluster.has_value()) throw std::invalid_argument("No such file or directory");
-
-  if (recursive) {
-    rm_recursive(path);
-    return;
-  }
+auto FileSystem::mv(std::string const &source, std::string const &destination, bool recursive) -> void {
+  std::unique_lock tree_lock(*tree_mutex_);
+  auto source_cluster = search(source);
+  if (!source_cluster.has_value()) throw std::invalid_argument("Source does not exist");
+  if (source_cluster.value() == 0) throw std::invalid_argument("Cannot move root directory");
+  if (does_exist(destination)) throw std::invalid_argument("Destination already exists");
 
-  if (handler_builder_.build_metadata_handler(file_cluster.value()).read_metadata().is_directory()) {
-    rmdir(path);
-    return;
+  auto destination_parent_cluster = search(dirname(destination));
+  if (!does_dir_exist(dirname(destination)) || !destination_parent_cluster.has_value()) {
+    throw std::invalid_argument("Destination parent directory does not exist");
   }
 
-  rmfile(path);
-}
-
-auto FileSystem::cp(std::string const &source, std::string const &destination, bool recursive) -> void {
-  if (!recursive) {
-    shallow_copy(source, destination);
-    return;
+  auto metadata_handler = handler_builder_.build_metadata_handler(source_cluster.value());
+  auto meta = metadata_handler.read_metadata();
+  if (meta.is_directory()) {
+    if (!recursive && !read_dir(source_cluster.value()).list_files().empty()) {
+      throw std::invalid_argument("Cannot move non-empty directory");
+    }
+    if (path_resolver_.is_descendant(destination_parent_cluster.value(), source_cluster.value())) {
+      throw std::invalid_argument("Cannot move directory into itself");
+    }
   }
 
-  deep_copy(source, destination);
-}
+  auto old_parent_cluster = meta.get_parent_first_cluster();
+  meta.set_name(basename(destination));
+  meta.set_parent_first_cluster(destination_parent_cluster.value());
+  auto meta_bytes = meta.to_bytes(); // validates the new name before the tree is touched
 
-auto FileSystem::mv(std::string const &source, std::string const &destination, bool recursive) -> void {
-  cp(source, destination, recursive);
-  rm(source, recursive);
+  remove_file_from_dir(old_parent_cluster, source_cluster.value());
+  handler_builder_.build_byte_writer(source_cluster.value()).write_bytes(0, meta_bytes);
+  add_file_to_dir(destination_parent_cluster.value(), source_cluster.value());
 }
 
 auto FileSystem::import_file(std::istream &in_stream, std::string const &path) -> void {
-  if (does_dir_exist(path)) throw std::invalid_argument("Cannot import nameless file to directory");
-  if (does_file_exist(path)) throw std::invalid_argument("File already exists");
+  auto file_cluster = make_import_target(path);
 
-  touch(path);
-  auto file_writer = get_writer(path);
+  std::shared_lock tree_lock(*tree_mutex_);
+  if (search(path) != file_cluster) throw std::runtime_error("File was removed during import");
+  std::unique_lock file_lock(inode_locks_->get(file_cluster));
+  auto file_writer = handler_builder_.build_file_writer(file_cluster);
   file_writer.set_offset(0);
 
+  LatencyHistogram::Timer timer(phase_latencies_->data);
   in_stream.seekg(0);
   std::istreambuf_iterator<char> iter(in_stream);
   std::istreambuf_iterator<char> end;
@@ -170,13 +393,44 @@ auto FileSystem::import_file(std::istream &in_stream, std::string const &path) -
   }
 }
 
+auto FileSystem::import_dir(std::string const &host_path, std::string const &path, std::size_t threads) -> void {
+  if (!std::filesystem::is_directory(host_path)) throw std::invalid_argument("Host directory does not exist");
+
+  std::unique_lock tree_lock(*tree_mutex_);
+  if (does_exist(path)) throw std::invalid_argument("Destination already exists");
+
+  auto parent_dir_cluster = search(dirname(path));
+  if (!does_dir_exist(dirname(path)) || !parent_dir_cluster.has_value()) {
+    throw std::invalid_argument("Parent directory does not exist");
+  }
+
+  // the skeleton and every extent are allocated in one pass, then only file data is left to move
+  std::vector<ImportJob> import_jobs;
+  std::vector<std::uint64_t> dir_clusters;
+  try {
+    auto dir_cluster =
+        prepare_import_dir(host_path, basename(path), parent_dir_cluster.value(), import_jobs, dir_clusters);
+    run_import_jobs(import_jobs, std::max<std::size_t>(1, threads));
+    add_file_to_dir(parent_dir_cluster.value(), dir_cluster);
+  } catch (...) {
+    // nothing is linked into the parent until the very end, so every chain allocated so far is simply released
+    for (auto const &import_job : import_jobs) fat_.free(import_job.destination_clusters.front());
+    for (auto dir_cluster : dir_clusters) fat_.free(dir_cluster);
+    throw;
+  }
+}
+
 auto FileSystem::export_file(std::string const &path, std::ostream &out_stream) const -> void {
-  if (!does_file_exist(path)) throw std::invalid_argument("File does not exist");
+  std::shared_lock tree_lock(*tree_mutex_);
+  auto file_cluster = search(path);
+  if (!does_file_exist(path) || !file_cluster.has_value()) throw std::invalid_argument("File does not exist");
 
-  auto file_reader = get_reader(path);
+  std::shared_lock file_lock(inode_locks_->get(file_cluster.value()));
+  auto file_reader = handler_builder_.build_file_reader(file_cluster.value());
   file_reader.set_block_size(settings_.cluster_size);
   file_reader.set_offset(0);
 
+  LatencyHistogram::Timer timer(phase_latencies_->data);
   auto buffer = file_reader.read_next();
   while (!buffer.empty()) {
     out_stream.write(
@@ -188,6 +442,297 @@ auto FileSystem::export_file(std::string const &path, std::ostream &out_stream)
   out_stream.flush();
 }
 
+auto FileSystem::export_dir(std::string const &path, std::string const &host_path, std::size_t threads) const
+    -> void {
+  std::shared_lock tree_lock(*tree_mutex_);
+  auto dir_cluster = search(path);
+  if (!does_dir_exist(path) || !dir_cluster.has_value()) throw std::invalid_argument("Directory does not exist");
+  if (std::filesystem::exists(host_path)) throw std::invalid_argument("Host destination already exists");
+
+  // one walk by cluster recreates the directories, files are left to the workers
+  std::unordered_map<std::uint64_t, std::filesystem::path> host_dirs; // directory cluster -> host directory
+  std::vector<ExportJob> export_jobs;
+
+  auto pre_order = [&](Metadata const &meta) {
+    auto is_root = meta.get_first_cluster() == dir_cluster.value();
+    auto host_entry = is_root ? std::filesystem::path(host_path)
+                              : host_dirs.at(meta.get_parent_first_cluster()) / meta.get_name();
+
+    if (meta.is_directory()) {
+      std::filesystem::create_directory(host_entry);
+      host_dirs.emplace(meta.get_first_cluster(), std::move(host_entry));
+    } else {
+      export_jobs.push_back({meta.get_first_cluster(), std::move(host_entry)});
+    }
+  };
+
+  tree_walker_.walk(dir_cluster.value(), pre_order);
+
+  LatencyHistogram::Timer timer(phase_latencies_->data);
+  run_export_jobs(export_jobs, std::max<std::size_t>(1, threads));
+}
+
+auto FileSystem::export_to_host(std::string const &path, std::string const &host_path) const -> void {
+  std::shared_lock tree_lock(*tree_mutex_);
+  auto file_cluster = search(path);
+  if (!does_file_exist(path) || !file_cluster.has_value()) throw std::invalid_argument("File does not exist");
+
+  std::shared_lock file_lock(inode_locks_->get(file_cluster.value()));
+  auto size = handler_builder_.build_metadata_handler(file_cluster.value()).read_metadata().get_size();
+
+  // the host file is only removed once it has been opened, and so truncated, here; a failed open leaves it alone
+  std::exception_ptr error;
+  {
+    HostFile host_file(host_path);
+    try {
+      LatencyHistogram::Timer timer(phase_latencies_->data);
+      copy_to_host(file_cluster.value(), size, host_file);
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+  if (error) {
+    std::error_code remove_error;
+    std::filesystem::remove(host_path, remove_error);
+    std::rethrow_exception(error);
+  }
+}
+
+auto FileSystem::import_from_host(std::string const &host_path, std::string const &path) -> void {
+  HostFile host_file(host_path, false);
+  auto size = host_file.get_size();
+
+  auto file_cluster = make_import_target(path);
+
+  try {
+    std::shared_lock tree_lock(*tree_mutex_);
+    if (search(path) != file_cluster) throw std::runtime_error("File was removed during import");
+
+    // the size is known, so the chain is allocated in full and the clusters after the header form one extent;
+    // the chain is read through a copy of the table, whose reader is not shared with other threads
+    std::unique_lock file_lock(inode_locks_->get(file_cluster));
+    auto fat = fat_;
+    auto header_clusters_count = calculate_clusters_count(0);
+    auto clusters_count = calculate_clusters_count(size);
+    if (clusters_count > header_clusters_count) {
+      auto header_chain = fat.get_chain(file_cluster, header_clusters_count);
+      fat.set_next(header_chain.back(), fat.allocate_chain(clusters_count - header_clusters_count).front());
+    }
+
+    LatencyHistogram::Timer timer(phase_latencies_->data);
+    copy_from_host(host_file, file_cluster, size);
+
+    auto metadata_handler = handler_builder_.build_metadata_handler(file_cluster);
+    auto meta = metadata_handler.read_metadata();
+    meta.set_size(size);
+    metadata_handler.write_metadata(meta);
+  } catch (...) {
+    // a failed import leaves no empty file behind, unless the path was taken over in the meantime
+    std::unique_lock tree_lock(*tree_mutex_);
+    if (search(path) == file_cluster) rmfile(path);
+    throw;
+  }
+}
+
+auto FileSystem::import_tar(std::istream &in_stream, std::string const &path) -> void {
+  std::unique_lock tree_lock(*tree_mutex_);
+  if (does_exist(path)) throw std::invalid_argument("Destination already exists");
+
+  auto parent_dir_cluster = search(dirname(path));
+  if (!does_dir_exist(dirname(path)) || !parent_dir_cluster.has_value()) {
+    throw std::invalid_argument("Parent directory does not exist");
+  }
+
+  // directories are created when an entry first needs them and written once, with their full listing, at the end;
+  // file data goes straight from the stream into its extent
+  std::unordered_map<std::string, std::uint64_t> dir_clusters; // archive path -> cluster
+  std::unordered_map<std::uint64_t, Metadata> dirs;            // cluster -> header
+  std::unordered_map<std::uint64_t, Directory> listings;       // cluster -> listing
+  std::unordered_set<std::string> file_paths;
+
+  auto add_dir = [&](std::string const &name, std::uint64_t parent_cluster) {
+    auto dir_meta = Metadata(name, 0, 0, parent_cluster, true);
+    static_cast<void>(dir_meta.to_bytes()); // validates the name before anything is allocated
+    auto dir_cluster = fat_.allocate();
+    dir_meta.set_first_cluster(dir_cluster);
+    dirs.emplace(dir_cluster, dir_meta);
+    listings.emplace(dir_cluster, Directory());
+    return dir_cluster;
+  };
+
+  std::function<std::uint64_t(std::string const &)> get_dir = [&](std::string const &tar_path) -> std::uint64_t {
+    if (auto dir = dir_clusters.find(tar_path); dir != dir_clusters.end()) return dir->second;
+    if (file_paths.contains(tar_path)) throw std::invalid_argument("Duplicate tar entry " + tar_path);
+
+    auto delimiter = tar_path.rfind('/');
+    auto parent_cluster = get_dir(delimiter == std::string::npos ? "" : tar_path.substr(0, delimiter));
+    auto dir_cluster = add_dir(tar_path.substr(delimiter + 1), parent_cluster);
+    listings.at(parent_cluster).add_file(dir_cluster);
+    dir_clusters.emplace(tar_path, dir_cluster);
+    return dir_cluster;
+  };
+
+  std::vector<std::uint64_t> file_chains; // first clusters of the files written so far
+  try {
+    auto root_cluster = add_dir(basename(path), parent_dir_cluster.value());
+    dir_clusters.emplace("", root_cluster);
+
+    LatencyHistogram::Timer timer(phase_latencies_->data);
+    for (auto header = Tar::read_entry(in_stream); header.has_value(); header = Tar::read_entry(in_stream)) {
+      auto const &tar_path = header->path;
+      std::istringstream components(tar_path);
+      for (std::string component; std::getline(components, component, '/');) {
+        if (component.empty() || component == "." || component == "..") {
+          throw std::invalid_argument("Invalid tar entry " + tar_path);
+        }
+      }
+
+      // links and devices have no counterpart here and are skipped
+      auto is_file = header->type == Tar::TypeOptions::FILE || header->type == Tar::TypeOptions::OLD_FILE;
+      if (header->type == Tar::TypeOptions::DIRECTORY && !tar_path.empty()) static_cast<void>(get_dir(tar_path));
+      if (!is_file || tar_path.empty()) {
+        Tar::skip(in_stream, header->size);
+        Tar::skip_padding(in_stream, header->size);
+        continue;
+      }
+
+      if (dir_clusters.contains(tar_path) || !file_paths.insert(tar_path).second) {
+        throw std::invalid_argument("Duplicate tar entry " + tar_path);
+      }
+      auto delimiter = tar_path.rfind('/');
+      auto parent_cluster = get_dir(delimiter == std::string::npos ? "" : tar_path.substr(0, delimiter));
+
+      auto file_meta = Metadata(tar_path.substr(delimiter + 1), header->size, 0, parent_cluster, false);
+      static_cast<void>(file_meta.to_bytes()); // validates the name before anything is allocated
+      auto file_clusters = fat_.allocate_chain(calculate_clusters_count(header->size));
+      file_chains.push_back(file_clusters.front());
+      file_meta.set_first_cluster(file_clusters.front());
+
+      write_stream(in_stream, file_meta, file_clusters);
+      Tar::skip_padding(in_stream, header->size);
+      listings.at(parent_cluster).add_file(file_clusters.front());
+    }
+
+    for (auto &[dir_cluster, dir_meta] : dirs) {
+      auto listing_bytes = listings.at(dir_cluster).to_bytes();
+      dir_meta.set_size(listing_bytes.size());
+      auto bytes = dir_meta.to_bytes();
+      bytes.insert(bytes.end(), listing_bytes.begin(), listing_bytes.end());
+      handler_builder_.build_byte_writer(dir_cluster).write_bytes(0, bytes);
+    }
+    add_file_to_dir(parent_dir_cluster.value(), root_cluster);
+  } catch (...) {
+    // the tree is linked into the parent last, so a rejected archive only has to give its clusters back
+    for (auto file_cluster : file_chains) fat_.free(file_cluster);
+    for (auto const &[dir_cluster, dir_meta] : dirs) fat_.free(dir_cluster);
+    throw;
+  }
+}
+
+auto FileSystem::export_tar(std::string const &path, std::ostream &out_stream) const -> void {
+  std::shared_lock tree_lock(*tree_mutex_);
+  auto dir_cluster = search(path);
+  if (!does_dir_exist(path) || !dir_cluster.has_value()) throw std::invalid_argument("Directory does not exist");
+
+  // entries are named relative to the exported directory, which is not an entry itself
+  std::unordered_map<std::uint64_t, std::string> tar_paths; // open directory cluster -> archive path
+
+  auto pre_order = [&](Metadata const &meta) {
+    if (meta.get_first_cluster() == dir_cluster.value()) {
+      tar_paths.emplace(meta.get_first_cluster(), "");
+      return;
+    }
+
+    auto const &parent_path = tar_paths.at(meta.get_parent_first_cluster());
+    auto tar_path = parent_path.empty() ? meta.get_name() : parent_path + "/" + meta.get_name();
+    if (meta.is_directory()) {
+      Tar::write_header(out_stream, {tar_path, 0, Tar::TypeOptions::DIRECTORY});
+      tar_paths.emplace(meta.get_first_cluster(), std::move(tar_path));
+      return;
+    }
+
+    // the size is read again under the file lock, the walk saw it before
+    std::shared_lock file_lock(inode_locks_->get(meta.get_first_cluster()));
+    auto size = handler_builder_.build_metadata_handler(meta.get_first_cluster()).read_metadata().get_size();
+    Tar::write_header(out_stream, {tar_path, size, Tar::TypeOptions::FILE});
+
+    auto file_reader = handler_builder_.build_file_reader(meta.get_first_cluster());
+    file_reader.set_block_size(STREAM_BLOCK_SIZE);
+    file_reader.set_offset(0);
+    for (auto block = file_reader.read_next(); !block.empty(); block = file_reader.read_next()) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      out_stream.write(reinterpret_cast<char const *>(block.data()), static_cast<std::streamsize>(block.size()));
+    }
+    Tar::write_padding(out_stream, size);
+  };
+
+  auto post_order = [&](Metadata const &meta) {
+    if (meta.is_directory()) tar_paths.erase(meta.get_first_cluster());
+  };
+
+  LatencyHistogram::Timer timer(phase_latencies_->data);
+  tree_walker_.walk(dir_cluster.value(), pre_order, post_order);
+  Tar::write_end(out_stream);
+  if (!out_stream) throw std::runtime_error("Cannot write tar stream");
+}
+
+auto FileSystem::read_file(std::string const &path) const -> std::vector<std::byte> {
+  std::shared_lock tree_lock(*tree_mutex_);
+  auto file_cluster = search(path);
+  if (!does_file_exist(path) || !file_cluster.has_value()) throw std::invalid_argument("File does not exist");
+
+  std::shared_lock file_lock(inode_locks_->get(file_cluster.value()));
+  auto meta = handler_builder_.build_metadata_handler(file_cluster.value()).read_metadata();
+  auto file_reader = handler_builder_.build_file_reader(file_cluster.value());
+  file_reader.set_block_size(meta.get_size());
+  file_reader.set_offset(0);
+  LatencyHistogram::Timer timer(phase_latencies_->data);
+  return file_reader.read();
+}
+
+auto FileSystem::write_file(std::string const &path, std::vector<std::byte> const &bytes, std::uint64_t offset)
+    -> void {
+  std::shared_lock tree_lock(*tree_mutex_);
+  auto file_cluster = search(path);
+  if (!does_file_exist(path) || !file_cluster.has_value()) throw std::invalid_argument("File does not exist");
+
+  std::unique_lock file_lock(inode_locks_->get(file_cluster.value()));
+  auto meta = handler_builder_.build_metadata_handler(file_cluster.value()).read_metadata();
+  if (offset > meta.get_size()) throw std::invalid_argument("Offset is out of file bounds");
+
+  auto file_writer = handler_builder_.build_file_writer(file_cluster.value());
+  file_writer.set_offset(offset);
+  LatencyHistogram::Timer timer(phase_latencies_->data);
+  file_writer.write(bytes);
+}
+
+auto FileSystem::async_read(std::string const &path) const -> std::future<std::vector<std::byte>> {
+  return executor_->submit([file_system = detach(), path]() { return file_system.read_file(path); });
+}
+
+auto FileSystem::async_write(std::string const &path, std::vector<std::byte> bytes, std::uint64_t offset)
+    -> std::future<void> {
+  return executor_->submit([file_system = detach(), path, bytes = std::move(bytes), offset]() mutable {
+    file_system.write_file(path, bytes, offset);
+  });
+}
+
+auto FileSystem::async_import(std::shared_ptr<std::istream> in_stream, std::string const &path) -> std::future<void> {
+  if (!in_stream) throw std::invalid_argument("Input stream is empty");
+  return executor_->submit([file_system = detach(), in_stream = std::move(in_stream), path]() mutable {
+    file_system.import_file(*in_stream, path);
+  });
+}
+
+auto FileSystem::async_cp(std::string const &source, std::string const &destination, bool recursive, bool reflink)
+    -> std::future<void> {
+  // recursive copies keep several clusters in flight with their own workers, sized like the executor
+  auto threads = executor_->get_threads_count();
+  return executor_->submit([file_system = detach(), source, destination, recursive, reflink, threads]() mutable {
+    file_system.cp(source, destination, recursive, reflink, threads);
+  });
+}
+
 auto FileSystem::rm_recursive(std::string const &path) -> void {
   auto file_cluster = search(path);
   if (!file_cluster.has_value()) throw std::invalid_argument("No such file or directory");
@@ -203,41 +748,52 @@ auto FileSystem::rm_recursive(std::string const &path) -> void {
     throw std::invalid_argument("Cannot remove working directory or its ancestor");
   }
 
-  auto dir = read_dir(meta.get_first_cluster());
-  auto child_clusters = dir.list_files();
-  for (auto const &child_cluster : child_clusters) { rm_recursive(path_resolver_.trace(child_cluster)); }
-  rmdir(path);
+  // children are listed before their parent is visited in post-order, so chains can be freed bottom-up
+  // without touching the listings of directories that are about to disappear anyway
+  tree_walker_.walk(meta.get_first_cluster(), {}, [this](Metadata const &child_meta) {
+    fat_.free(child_meta.get_first_cluster());
+  });
+  remove_file_from_dir(meta.get_parent_first_cluster(), meta.get_first_cluster());
 }
 
 auto FileSystem::cd(std::string const &path) -> void {
+  std::unique_lock tree_lock(*tree_mutex_);
   auto dir_cluster = search(path);
   if (!does_dir_exist(path) || !dir_cluster.has_value()) throw std::invalid_argument("Directory does not exist");
   working_dir_cluster_ = dir_cluster.value();
 }
 
-auto FileSystem::cat(std::string const &path, std::ostream &out_stream) const -> void {
+auto FileSystem::cat(std::string const &path, std::ostream &out_stream, std::uint64_t offset,
+                     std::uint64_t length) const -> void {
+  std::shared_lock tree_lock(*tree_mutex_);
   auto file_cluster = search(path);
   if (!file_cluster.has_value()) throw std::invalid_argument("File does not exist");
-  if (handler_builder_.build_metadata_handler(file_cluster.value()).read_metadata().is_directory()) {
-    throw std::invalid_argument("Cannot cat directory");
-  }
 
-  auto file_reader = handler_builder_.build_file_reader(file_cluster.value());
-  file_reader.set_block_size(settings_.cluster_size);
-  file_reader.set_offset(0);
+  std::shared_lock file_lock(inode_locks_->get(file_cluster.value()));
+  auto meta = handler_builder_.build_metadata_handler(file_cluster.value()).read_metadata();
+  if (meta.is_directory()) throw std::invalid_argument("Cannot cat directory");
 
-  auto file_bytes = file_reader.read_next();
-  while (!file_bytes.empty()) {
-    out_stream << Converter::to_string(file_bytes);
-    file_bytes = file_reader.read_next();
-  }
+  auto begin = std::min(offset, meta.get_size());
+  write_range(file_cluster.value(), begin, begin + std::min(length, meta.get_size() - begin), out_stream);
 }
 
-auto FileSystem::check_signature() -> bool {
+auto FileSystem::tail(std::string const &path, std::ostream &out_stream, std::uint64_t count) const -> void {
+  std::shared_lock tree_lock(*tree_mutex_);
+  auto file_cluster = search(path);
+  if (!file_cluster.has_value()) throw std::invalid_argument("File does not exist");
+
+  // the size is read under the file lock, so the range is the tail even while writers append
+  std::shared_lock file_lock(inode_locks_->get(file_cluster.value()));
+  auto meta = handler_builder_.build_metadata_handler(file_cluster.value()).read_metadata();
+  if (meta.is_directory()) throw std::invalid_argument("Cannot tail directory");
+
+  write_range(file_cluster.value(), meta.get_size() - std::min(count, meta.get_size()), meta.get_size(), out_stream);
+}
+
+auto FileSystem::read_signature() -> std::string {
   disk_reader_.set_offset(0);
   disk_reader_.set_block_size(FSMaker::get_signature_size());
-  auto signature_bytes = disk_reader_.read();
-  return Converter::to_string(signature_bytes) == FSMaker::get_signature();
+  return Converter::to_string(disk_reader_.read());
 }
 
 auto FileSystem::read_settings() -> void {
@@ -261,6 +817,7 @@ auto FileSystem::create_root_dir() -> void {
 }
 
 auto FileSystem::read_dir(std::uint64_t cluster) const -> Directory {
+  LatencyHistogram::Timer timer(phase_latencies_->metadata);
   auto metadata_handler = handler_builder_.build_metadata_handler(cluster);
   auto dir_reader = handler_builder_.build_file_reader(cluster);
   dir_reader.set_block_size(metadata_handler.read_metadata().get_size());
@@ -268,15 +825,12 @@ auto FileSystem::read_dir(std::uint64_t cluster) const -> Directory {
 }
 
 auto FileSystem::get_metadata_from_clusters(const std::vector<std::uint64_t> &clusters) const -> std::vector<Metadata> {
-  std::vector<Metadata> metadata_list;
-  metadata_list.reserve(clusters.size());
-  std::transform(clusters.begin(), clusters.end(), std::back_inserter(metadata_list), [this](auto const &cluster) {
-    return handler_builder_.build_metadata_handler(cluster).read_metadata();
-  });
-  return metadata_list;
+  LatencyHistogram::Timer timer(phase_latencies_->metadata);
+  return handler_builder_.read_metadata_batch(clusters);
 }
 
 auto FileSystem::search(std::string const &path) const -> std::optional<std::uint64_t> {
+  LatencyHistogram::Timer timer(phase_latencies_->resolve);
   return path_resolver_.search(path, working_dir_cluster_);
 }
 
@@ -327,6 +881,11 @@ auto FileSystem::overwrite_file(std::uint64_t cluster, Metadata old_meta, std::v
   handler_builder_.build_file_writer(cluster).write(bytes);
 }
 
+auto FileSystem::calculate_clusters_count(std::uint64_t file_size) const noexcept -> std::uint64_t {
+  auto bytes = Metadata::get_metadata_size() + file_size;
+  return (bytes + settings_.cluster_size - 1) / settings_.cluster_size;
+}
+
 auto FileSystem::rmfile(std::string const &path) -> void {
   auto file_cluster = search(path);
   if (!file_cluster.has_value()) throw std::invalid_argument("File does not exist");
@@ -341,7 +900,7 @@ auto FileSystem::rmfile(std::string const &path) -> void {
   remove_file_from_dir(parent_dir_cluster, file_cluster.value());
 }
 
-auto FileSystem::shallow_copy(std::string const &source, std::string const &destination) -> void {
+auto FileSystem::shallow_copy(std::string const &source, std::string const &destination, bool reflink) -> void {
   if (does_exist(destination)) throw std::invalid_argument("Destination already exists");
 
   auto source_cluster = search(source);
@@ -353,28 +912,26 @@ auto FileSystem::shallow_copy(std::string const &source, std::string const &dest
   }
 
   if (source_meta.is_directory()) {
-    mkdir(destination);
+    make_dir(destination);
     return;
   }
 
-  touch(destination);
-  auto source_reader = handler_builder_.build_file_reader(source_cluster.value());
-  auto destination_cluster = search(destination);
-  if (!destination_cluster.has_value()) throw std::invalid_argument("Destination does not exist");
-  auto destination_writer = handler_builder_.build_file_writer(destination_cluster.value());
-
-  source_reader.set_block_size(settings_.cluster_size);
-  source_reader.set_offset(0);
-  destination_writer.set_offset(0);
+  auto parent_dir_cluster = search(dirname(destination));
+  if (!does_dir_exist(dirname(destination)) || !parent_dir_cluster.has_value()) {
+    throw std::invalid_argument("Parent directory does not exist");
+  }
 
-  auto buffer = source_reader.read_next();
-  while (!buffer.empty()) {
-    destination_writer.write_next(buffer);
-    buffer = source_reader.read_next();
+  auto destination_cluster = copy_file_data(source_meta, basename(destination), parent_dir_cluster.value(), reflink);
+  try {
+    add_file_to_dir(parent_dir_cluster.value(), destination_cluster);
+  } catch (...) {
+    fat_.free(destination_cluster);
+    throw;
   }
 }
 
-auto FileSystem::deep_copy(std::string const &source, std::string const &destination) -> void {
+auto FileSystem::deep_copy(std::string const &source, std::string const &destination, bool reflink,
+                           std::size_t threads) -> void {
   if (!does_exist(source)) throw std::invalid_argument("Source does not exist");
   if (does_exist(destination)) throw std::invalid_argument("Destination already exists");
 
@@ -383,24 +940,461 @@ auto FileSystem::deep_copy(std::string const &source, std::string const &destina
 
   auto source_meta = handler_builder_.build_metadata_handler(source_cluster.value()).read_metadata();
   if (!source_meta.is_directory() || read_dir(source_cluster.value()).list_files().empty()) {
-    shallow_copy(source, destination);
+    shallow_copy(source, destination, reflink);
     return;
   }
 
-  mkdir(destination);
-  auto destination_cluster = search(destination);
-  if (!destination_cluster.has_value()) throw std::invalid_argument("Destination does not exist");
+  auto parent_dir_cluster = search(dirname(destination));
+  if (!does_dir_exist(dirname(destination)) || !parent_dir_cluster.has_value()) {
+    throw std::invalid_argument("Parent directory does not exist");
+  }
+  if (path_resolver_.is_descendant(parent_dir_cluster.value(), source_cluster.value())) {
+    throw std::invalid_argument("Cannot copy directory into itself");
+  }
 
-  auto source_dir = read_dir(source_cluster.value());
-  auto child_clusters = source_dir.list_files();
-  for (auto const &child_cluster : child_clusters) {
-    auto child_meta = handler_builder_.build_metadata_handler(child_cluster).read_metadata();
-    auto child_destination = path_resolver_.trace(destination_cluster.value()) + "/" + child_meta.get_name();
-    cp(path_resolver_.trace(child_cluster), child_destination, true);
+  auto destination_name = basename(destination);
+  static_cast<void>(Metadata(destination_name, 0, 0, 0, true).to_bytes()); // validates the name up front
+
+  // directories are allocated on the way down and written once, with their full listing, on the way up
+  std::unordered_map<std::uint64_t, Metadata> copied_dirs; // source cluster -> destination header
+  std::unordered_map<std::uint64_t, Directory> listings;   // destination cluster -> destination listing
+
+  // in parallel mode the skeleton and every chain are allocated here, workers only move file data
+  auto is_parallel = threads > 1 && !reflink;
+  std::vector<CopyJob> copy_jobs;
+  std::vector<std::uint64_t> copy_clusters; // first clusters of everything allocated for the copy
+
+  auto pre_order = [&](Metadata const &meta) {
+    auto is_root = meta.get_first_cluster() == source_cluster.value();
+    auto name = is_root ? destination_name : meta.get_name();
+    auto parent = is_root ? parent_dir_cluster.value()
+                          : copied_dirs.at(meta.get_parent_first_cluster()).get_first_cluster();
+
+    std::uint64_t copy_cluster = 0;
+    if (meta.is_directory()) {
+      copy_cluster = fat_.allocate();
+      copied_dirs.emplace(meta.get_first_cluster(), Metadata(name, 0, copy_cluster, parent, true));
+      listings.emplace(copy_cluster, Directory());
+    } else if (is_parallel) {
+      copy_jobs.push_back(prepare_copy(meta, name, parent));
+      copy_cluster = copy_jobs.back().destination_clusters.front();
+    } else {
+      copy_cluster = copy_file_data(meta, name, parent, reflink);
+    }
+    copy_clusters.push_back(copy_cluster);
+
+    if (!is_root) listings.at(parent).add_file(copy_cluster);
+  };
+
+  auto post_order = [&](Metadata const &meta) {
+    if (!meta.is_directory()) return;
+
+    auto copy_meta = copied_dirs.at(meta.get_first_cluster());
+    auto listing_bytes = listings.at(copy_meta.get_first_cluster()).to_bytes();
+    copy_meta.set_size(listing_bytes.size());
+
+    auto bytes = copy_meta.to_bytes();
+    bytes.insert(bytes.end(), listing_bytes.begin(), listing_bytes.end());
+    handler_builder_.build_byte_writer(copy_meta.get_first_cluster()).write_bytes(0, bytes);
+    listings.erase(copy_meta.get_first_cluster());
+  };
+
+  try {
+    tree_walker_.walk(source_cluster.value(), pre_order, post_order);
+    if (is_parallel) run_copy_jobs(copy_jobs, threads);
+    add_file_to_dir(parent_dir_cluster.value(), copied_dirs.at(source_cluster.value()).get_first_cluster());
+  } catch (...) {
+    // the copy is linked into the parent last, so a failed one only has to give its clusters back
+    for (auto copy_cluster : copy_clusters) fat_.free(copy_cluster);
+    throw;
   }
 }
 
+auto FileSystem::copy_file_data(Metadata const &source_meta, std::string const &name, std::uint64_t parent_cluster,
+                                bool reflink) -> std::uint64_t {
+  // the chain is released again when the copy fails, the caller only learns about chains that were filled
+  if (!reflink) {
+    auto copy_job = prepare_copy(source_meta, name, parent_cluster);
+    try {
+      run_copy_job(handler_builder_, copy_job);
+    } catch (...) {
+      fat_.free(copy_job.destination_clusters.front());
+      throw;
+    }
+    return copy_job.destination_clusters.front();
+  }
+
+  auto destination_meta = Metadata(name, source_meta.get_size(), 0, parent_cluster, false);
+  static_cast<void>(destination_meta.to_bytes()); // validates the name before anything is allocated
+
+  auto destination_cluster = fat_.allocate();
+  try {
+    handler_builder_.build_cluster_copier().clone(source_meta.get_first_cluster(), destination_cluster);
+    destination_meta.set_first_cluster(destination_cluster);
+    handler_builder_.build_byte_writer(destination_cluster).write_bytes(0, destination_meta.to_bytes());
+  } catch (...) {
+    fat_.free(destination_cluster);
+    throw;
+  }
+  return destination_cluster;
+}
+
+auto FileSystem::prepare_copy(Metadata const &source_meta, std::string const &name, std::uint64_t parent_cluster)
+    -> CopyJob {
+  auto destination_meta = Metadata(name, source_meta.get_size(), 0, parent_cluster, false);
+  static_cast<void>(destination_meta.to_bytes()); // validates the name before anything is allocated
+
+  auto destination_clusters = fat_.allocate_chain(calculate_clusters_count(source_meta.get_size()));
+  destination_meta.set_first_cluster(destination_clusters.front());
+  return {source_meta.get_first_cluster(), std::move(destination_clusters), std::move(destination_meta)};
+}
+
+auto FileSystem::run_copy_job(HandlerBuilder const &handler_builder, CopyJob const &copy_job) -> void {
+  // the data is copied cluster by cluster, the header is only written once the chain is filled
+  handler_builder.build_cluster_copier().copy(copy_job.source_cluster, copy_job.destination_clusters);
+  auto destination_cluster = copy_job.destination_clusters.front();
+  handler_builder.build_byte_writer(destination_cluster).write_bytes(0, copy_job.destination_meta.to_bytes());
+}
+
+auto FileSystem::run_copy_jobs(std::vector<CopyJob> const &copy_jobs, std::size_t threads) const -> void {
+  // chains are preallocated and the disk is positional, so workers share the handler builder as is
+  std::atomic<std::size_t> next_job{0};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto worker = [&]() {
+    try {
+      for (auto job = next_job++; job < copy_jobs.size(); job = next_job++) {
+        run_copy_job(handler_builder_, copy_jobs[job]);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) error = std::current_exception();
+      next_job = copy_jobs.size();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(std::min(threads, copy_jobs.size()));
+  for (std::size_t i = 0; i < std::min(threads, copy_jobs.size()); ++i) workers.emplace_back(worker);
+  for (auto &thread : workers) thread.join();
+
+  if (error) std::rethrow_exception(error);
+}
+
+auto FileSystem::prepare_import_dir(std::filesystem::path const &host_path, std::string const &name,
+                                    std::uint64_t parent_cluster, std::vector<ImportJob> &import_jobs,
+                                    std::vector<std::uint64_t> &dir_clusters) -> std::uint64_t {
+  auto dir_meta = Metadata(name, 0, 0, parent_cluster, true);
+  static_cast<void>(dir_meta.to_bytes()); // validates the name before anything is allocated
+
+  auto dir_cluster = fat_.allocate();
+  dir_clusters.push_back(dir_cluster);
+  dir_meta.set_first_cluster(dir_cluster);
+
+  // entries are imported in name order, so the same host tree always gives the same image
+  std::vector<std::filesystem::directory_entry> entries(std::filesystem::directory_iterator(host_path), {});
+  std::sort(entries.begin(), entries.end(), [](auto const &lhs, auto const &rhs) { return lhs.path() < rhs.path(); });
+
+  // symlinks are not followed, they and special files are skipped
+  Directory listing;
+  for (auto const &entry : entries) {
+    auto type = entry.symlink_status().type();
+    auto entry_name = entry.path().filename().string();
+    if (type == std::filesystem::file_type::directory) {
+      listing.add_file(prepare_import_dir(entry.path(), entry_name, dir_cluster, import_jobs, dir_clusters));
+    } else if (type == std::filesystem::file_type::regular) {
+      import_jobs.push_back(prepare_import(entry.path(), entry_name, dir_cluster));
+      listing.add_file(import_jobs.back().destination_clusters.front());
+    }
+  }
+
+  auto listing_bytes = listing.to_bytes();
+  dir_meta.set_size(listing_bytes.size());
+  auto bytes = dir_meta.to_bytes();
+  bytes.insert(bytes.end(), listing_bytes.begin(), listing_bytes.end());
+  handler_builder_.build_byte_writer(dir_cluster).write_bytes(0, bytes);
+  return dir_cluster;
+}
+
+auto FileSystem::prepare_import(std::filesystem::path const &host_path, std::string const &name,
+                                std::uint64_t parent_cluster) -> ImportJob {
+  auto destination_meta = Metadata(name, std::filesystem::file_size(host_path), 0, parent_cluster, false);
+  static_cast<void>(destination_meta.to_bytes()); // validates the name before anything is allocated
+
+  // the size is known up front, so the whole file gets one contiguous extent when there is room for it
+  auto destination_clusters = fat_.allocate_chain(calculate_clusters_count(destination_meta.get_size()));
+  destination_meta.set_first_cluster(destination_clusters.front());
+  return {host_path, std::move(destination_clusters), std::move(destination_meta)};
+}
+
+auto FileSystem::read_host_file(ImportJob const &import_job,
+                                std::function<void(std::size_t, std::vector<std::byte>)> const &on_block) const
+    -> void {
+  std::ifstream in_stream(import_job.host_path, std::ios::binary);
+  if (!in_stream.is_open()) throw std::invalid_argument("Cannot open " + import_job.host_path.string());
+
+  // the file is handed on in batches of whole clusters with the header in front of the first one, so a reader
+  // holds one batch at a time whatever the size of the file
+  auto batch_size = get_batch_size();
+  auto buffer = import_job.destination_meta.to_bytes();
+  auto remaining = import_job.destination_meta.get_size();
+  std::size_t next_cluster = 0;
+  while (true) {
+    auto count = std::min<std::uint64_t>(remaining, batch_size - buffer.size());
+    auto offset = buffer.size();
+    buffer.resize(offset + count);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    in_stream.read(reinterpret_cast<char *>(buffer.data() + offset), static_cast<std::streamsize>(count));
+    if (static_cast<std::uint64_t>(in_stream.gcount()) != count) {
+      throw std::runtime_error("Host file changed during import: " + import_job.host_path.string());
+    }
+    remaining -= count;
+
+    auto clusters_count = (buffer.size() + settings_.cluster_size - 1) / settings_.cluster_size;
+    if (remaining == 0 && in_stream.peek() != std::ifstream::traits_type::eof()) {
+      throw std::runtime_error("Host file changed during import: " + import_job.host_path.string());
+    }
+    on_block(next_cluster, std::move(buffer));
+    next_cluster += clusters_count;
+    buffer = {};
+
+    if (remaining == 0) break;
+  }
+}
+
+auto FileSystem::run_import_jobs(std::vector<ImportJob> const &import_jobs, std::size_t threads) const -> void {
+  // readers load host files in any order, the calling thread is the writer stage and puts every block into its
+  // extent as soon as it is loaded; at most two blocks per reader wait in memory
+  auto readers_count = std::min(threads, import_jobs.size());
+  auto capacity = 2 * readers_count;
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::deque<ImportBlock> loaded;
+  std::size_t running_readers = readers_count;
+  std::atomic<std::size_t> next_job{0};
+  std::exception_ptr error;
+
+  auto fail = [&](std::exception_ptr exception) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!error) error = std::move(exception);
+    next_job = import_jobs.size();
+    condition.notify_all();
+  };
+
+  auto reader = [&]() {
+    try {
+      for (auto job = next_job++; job < import_jobs.size(); job = next_job++) {
+        read_host_file(import_jobs[job], [&](std::size_t first_cluster, std::vector<std::byte> bytes) {
+          std::unique_lock lock(mutex);
+          condition.wait(lock, [&]() { return loaded.size() < capacity || error; });
+          if (error) throw std::runtime_error("Import cancelled");
+          loaded.push_back({job, first_cluster, std::move(bytes)});
+          condition.notify_all();
+        });
+      }
+    } catch (...) { fail(std::current_exception()); }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    --running_readers;
+    condition.notify_all();
+  };
+
+  std::vector<std::thread> readers;
+  readers.reserve(readers_count);
+  for (std::size_t i = 0; i < readers_count; ++i) readers.emplace_back(reader);
+
+  LatencyHistogram::Timer timer(phase_latencies_->data);
+  while (true) {
+    std::unique_lock lock(mutex);
+    condition.wait(lock, [&]() { return !loaded.empty() || running_readers == 0 || error; });
+    if (error || loaded.empty()) break;
+
+    auto block = std::move(loaded.front());
+    loaded.pop_front();
+    condition.notify_all();
+    lock.unlock();
+
+    try {
+      write_to_chain(import_jobs[block.job].destination_clusters, block.first_cluster, block.bytes);
+    } catch (...) { fail(std::current_exception()); }
+  }
+
+  for (auto &thread : readers) thread.join();
+  if (error) std::rethrow_exception(error);
+}
+
+auto FileSystem::run_export_job(ExportJob const &export_job) const -> void {
+  std::shared_lock file_lock(inode_locks_->get(export_job.cluster));
+  auto size = handler_builder_.build_metadata_handler(export_job.cluster).read_metadata().get_size();
+  HostFile host_file(export_job.host_path);
+  copy_to_host(export_job.cluster, size, host_file);
+}
+
+auto FileSystem::get_data_extents(std::uint64_t cluster, std::uint64_t size) const -> std::vector<Extent> {
+  // the data follows the header in the chain, every run of adjacent clusters holds one piece of it
+  auto fat = fat_;
+  auto chain = fat.get_chain(cluster, calculate_clusters_count(size));
+  auto cluster_size = settings_.cluster_size;
+  auto clusters_start = FSMaker::calculate_clusters_start_offset(settings_);
+  auto data_begin = Metadata::get_metadata_size();
+  auto data_end = data_begin + size;
+
+  std::vector<Extent> extents;
+  std::uint64_t run_begin = 0;
+  for (auto const &run : ClusterCopier::get_runs(chain, 0, chain.size())) {
+    auto run_end = run_begin + run.count * cluster_size;
+    auto begin = std::max(run_begin, data_begin);
+    auto end = std::min(run_end, data_end);
+    if (begin < end) {
+      extents.push_back({clusters_start + run.first_cluster * cluster_size + (begin - run_begin), begin - data_begin,
+                         end - begin});
+    }
+    run_begin = run_end;
+  }
+  return extents;
+}
+
+auto FileSystem::copy_to_host(std::uint64_t cluster, std::uint64_t size, HostFile &host_file) const -> void {
+  // the first extent tells whether the disk can copy inside the kernel, otherwise the data goes through memory
+  auto extents = get_data_extents(cluster, size);
+  auto is_kernel_copy = !extents.empty() && host_file.get_fd() >= 0 &&
+                        disk_->copy_to_fd(extents.front().offset, extents.front().size, host_file.get_fd(), 0);
+  if (is_kernel_copy) {
+    io_stats_->record_read(extents.front().offset, extents.front().size);
+    for (std::size_t i = 1; i < extents.size(); ++i) {
+      auto const &extent = extents[i];
+      if (!disk_->copy_to_fd(extent.offset, extent.size, host_file.get_fd(), extent.file_offset)) {
+        throw std::runtime_error("Cannot copy to host file");
+      }
+      io_stats_->record_read(extent.offset, extent.size);
+    }
+    return;
+  }
+
+  auto file_reader = handler_builder_.build_file_reader(cluster);
+  file_reader.set_block_size(STREAM_BLOCK_SIZE);
+  file_reader.set_offset(0);
+  for (auto block = file_reader.read_next(); !block.empty(); block = file_reader.read_next()) host_file.write(block);
+}
+
+auto FileSystem::write_range(std::uint64_t cluster, std::uint64_t begin, std::uint64_t end,
+                             std::ostream &out_stream) const -> void {
+  // the chain is walked once up to the end of the range, data before it is never read
+  LatencyHistogram::Timer timer(phase_latencies_->data);
+  for (auto const &extent : get_data_extents(cluster, end)) {
+    auto extent_begin = std::max(begin, extent.file_offset);
+    auto extent_end = extent.file_offset + extent.size;
+    for (auto position = extent_begin; position < extent_end; position += STREAM_BLOCK_SIZE) {
+      auto count = std::min(STREAM_BLOCK_SIZE, extent_end - position);
+      auto block = disk_reader_.read_batch({{extent.offset + (position - extent.file_offset), count}}).front();
+      if (block.size() != count) throw std::runtime_error("Unexpected end of image");
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      out_stream.write(reinterpret_cast<char const *>(block.data()), static_cast<std::streamsize>(block.size()));
+    }
+  }
+}
+
+auto FileSystem::copy_from_host(HostFile &host_file, std::uint64_t cluster, std::uint64_t size) -> void {
+  auto extents = get_data_extents(cluster, size);
+  auto is_kernel_copy = !extents.empty() && host_file.get_fd() >= 0 &&
+                        disk_->copy_from_fd(host_file.get_fd(), 0, extents.front().offset, extents.front().size);
+  if (is_kernel_copy) {
+    io_stats_->record_write(extents.front().offset, extents.front().size);
+    for (std::size_t i = 1; i < extents.size(); ++i) {
+      auto const &extent = extents[i];
+      if (!disk_->copy_from_fd(host_file.get_fd(), extent.file_offset, extent.offset, extent.size)) {
+        throw std::runtime_error("Cannot copy from host file");
+      }
+      io_stats_->record_write(extent.offset, extent.size);
+    }
+    return;
+  }
+
+  for (auto const &extent : extents) {
+    for (std::uint64_t done = 0; done < extent.size; done += STREAM_BLOCK_SIZE) {
+      auto count = std::min(STREAM_BLOCK_SIZE, extent.size - done);
+      auto bytes = host_file.read(count);
+      if (bytes.size() != count) throw std::runtime_error("Host file changed during import");
+      disk_writer_.write_batch({{extent.offset + done, std::move(bytes)}});
+    }
+  }
+}
+
+auto FileSystem::write_stream(std::istream &in_stream, Metadata const &meta,
+                              std::vector<std::uint64_t> const &clusters) const -> void {
+  // header and data go out together in batches of whole clusters, so a file of any size takes one batch of memory
+  auto batch_size = get_batch_size();
+  auto buffer = meta.to_bytes();
+  auto remaining = meta.get_size();
+  std::size_t next_cluster = 0;
+  while (true) {
+    auto count = std::min<std::uint64_t>(remaining, batch_size - buffer.size());
+    auto offset = buffer.size();
+    buffer.resize(offset + count);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    in_stream.read(reinterpret_cast<char *>(buffer.data() + offset), static_cast<std::streamsize>(count));
+    if (static_cast<std::uint64_t>(in_stream.gcount()) != count) {
+      throw std::invalid_argument("Unexpected end of stream");
+    }
+    remaining -= count;
+
+    write_to_chain(clusters, next_cluster, buffer);
+    next_cluster += (buffer.size() + settings_.cluster_size - 1) / settings_.cluster_size;
+    buffer.clear();
+
+    if (remaining == 0) break;
+  }
+}
+
+auto FileSystem::get_batch_size() const noexcept -> std::uint64_t {
+  return std::max<std::uint64_t>(1, STREAM_BLOCK_SIZE / settings_.cluster_size) * settings_.cluster_size;
+}
+
+auto FileSystem::write_to_chain(std::vector<std::uint64_t> const &clusters, std::size_t first_cluster,
+                                std::vector<std::byte> const &bytes) const -> void {
+  // bytes start at the given cluster of the chain, every run of adjacent clusters goes out in one write
+  auto cluster_writer = handler_builder_.build_cluster_writer();
+  auto cluster_size = settings_.cluster_size;
+  auto clusters_count = (bytes.size() + cluster_size - 1) / cluster_size;
+
+  std::uint64_t written = 0;
+  for (auto const &run : ClusterCopier::get_runs(clusters, first_cluster, first_cluster + clusters_count)) {
+    auto size = std::min(run.count * cluster_size, bytes.size() - written);
+    auto begin = bytes.begin() + static_cast<std::int64_t>(written);
+    cluster_writer.write_clusters(run.first_cluster,
+                                  std::vector<std::byte>(begin, begin + static_cast<std::int64_t>(size)));
+    written += size;
+  }
+}
+
+auto FileSystem::run_export_jobs(std::vector<ExportJob> const &export_jobs, std::size_t threads) const -> void {
+  // every worker streams whole files, so each host file is written by a single descriptor
+  std::atomic<std::size_t> next_job{0};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto worker = [&]() {
+    try {
+      for (auto job = next_job++; job < export_jobs.size(); job = next_job++) run_export_job(export_jobs[job]);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) error = std::current_exception();
+      next_job = export_jobs.size();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(std::min(threads, export_jobs.size()));
+  for (std::size_t i = 0; i < std::min(threads, export_jobs.size()); ++i) workers.emplace_back(worker);
+  for (auto &thread : workers) thread.join();
+
+  if (error) std::rethrow_exception(error);
+}
+
 auto operator<<(std::ostream &out_stream, FileSystem const &file_system) -> std::ostream & {
+  std::shared_lock tree_lock(*file_system.tree_mutex_);
   out_stream << "FileSystem:\n";
   out_stream << "Settings:\n";
   out_stream << "    Size: " << file_system.settings_.size << '\n';
@@ -408,5 +1402,6 @@ auto operator<<(std::ostream &out_stream, FileSystem const &file_system) -> std:
   try {
     out_stream << FAT::to_string(file_system.fat_);
   } catch (std::exception const &e) { out_stream << "FAT: " << e.what() << '\n'; }
+  out_stream << IOStats::to_string(file_system.io_stats());
   return out_stream;
 }
@@ -1,26 +1,96 @@
 #pragma once
 
 #include "Converter/Converter.hpp"
+#include "DirCursor/DirCursor.hpp"
 #include "DiskHandler/DiskReader/DiskReader.hpp"
 #include "DiskHandler/DiskWriter/DiskWriter.hpp"
 #include "FAT/FAT.hpp"
 #include "FSMaker/FSMaker.hpp"
 #include "FileHandler/FileReader/FileReader.hpp"
 #include "FileHandler/FileWriter/FileWriter.hpp"
+#include "DiskHandler/Disk/CombiningDisk/CombiningDisk.hpp"
+#include "DiskHandler/Disk/FileDisk/FileDisk.hpp"
+#include "DiskHandler/Disk/StreamDisk/StreamDisk.hpp"
+#include "DiskHandler/Disk/UringDisk/UringDisk.hpp"
 #include "FileHandler/HandlerBuilder/HandlerBuilder.hpp"
+#include "HostFile/HostFile.hpp"
+#include "IOStats/IOStats.hpp"
+#include "LatencyHistogram/LatencyHistogram.hpp"
+#include "LockTable/LockTable.hpp"
 #include "Metadata/Metadata.hpp"
 #include "PathResolver/PathResolver.hpp"
+#include "Tar/Tar.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+#include "TreeWalker/TreeWalker.hpp"
+#include "Writeback/Writeback.hpp"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 #include <iostream>
 
+// Every public operation is safe to call concurrently. Lookups and file operations hold the tree lock shared plus
+// the lock of the file or directory they touch, operations that create, unlink or relink entries rewrite listings and
+// hold the tree lock alone.
+// Readers and writers handed out by get_reader and get_writer are not synchronized.
+// The async_ methods run the matching operation on an internal executor and report its result through a future.
+// Writes are buffered and written back by a background thread; sync() makes them durable in the image right away.
 class FileSystem {
+public:
+  // time spent in each phase of the public operations; phases nest, a lookup reads directory metadata too
+  struct PhaseLatencies {
+    LatencyHistogram resolve;  // path lookups
+    LatencyHistogram metadata; // directory listings and metadata reads
+    LatencyHistogram data;     // file contents
+  };
+
+  // totals of a subtree, the subtree root included; size sums file contents, clusters count headers and listings too
+  // and clusters shared by reflinks once per file
+  struct DiskUsage {
+    std::uint64_t files_count;
+    std::uint64_t dirs_count;
+    std::uint64_t size;
+    std::uint64_t clusters_count;
+  };
+
+private:
+  struct CopyJob;
+  struct ImportJob;
+  struct ImportBlock;
+  struct ExportJob;
+  struct Extent;
+
+  static const std::uint64_t MAX_DIRTY_BYTES = 1048576; // 1 MiB
+  static constexpr std::chrono::milliseconds MAX_DIRTY_AGE{100};
+  static const std::uint64_t WRITEBACK_DIRTY_BYTES = 262144; // 256 KiB
+  static constexpr std::chrono::milliseconds WRITEBACK_AGE{30};
+  static constexpr std::chrono::milliseconds WRITEBACK_INTERVAL{10};
+  static constexpr std::uint64_t STREAM_BLOCK_SIZE = 262144; // 256 KiB
+  static const std::size_t READDIR_CHUNK_SIZE = 256;
+
   FSMaker::Settings settings_ = {};
 
+  std::shared_ptr<IOStats> io_stats_;
+  std::shared_ptr<CombiningDisk> disk_;
   DiskReader disk_reader_;
   DiskWriter disk_writer_;
 
@@ -30,15 +100,34 @@ class FileSystem {
 
   PathResolver path_resolver_;
 
+  TreeWalker tree_walker_;
+
   std::uint64_t working_dir_cluster_ = 0;
 
+  std::shared_ptr<std::shared_mutex> tree_mutex_ = std::make_shared<std::shared_mutex>();
+  std::shared_ptr<LockTable> inode_locks_ = std::make_shared<LockTable>();
+
+  std::shared_ptr<Writeback> writeback_;
+  std::shared_ptr<PhaseLatencies> phase_latencies_ = std::make_shared<PhaseLatencies>();
+
+  std::shared_ptr<ThreadPool> executor_ =
+      std::make_shared<ThreadPool>(std::max(1U, std::thread::hardware_concurrency()));
+
 public:
   FileSystem() = default;
   explicit FileSystem(std::string const &path);
 
   static auto make(std::string const &path, FSMaker::Settings const &settings, bool allow_big = false) -> void;
 
+  auto sync() -> void;
+  auto drain() -> void;
+
   [[nodiscard]] auto get_settings() const noexcept -> FSMaker::Settings const &;
+  [[nodiscard]] auto get_allocated_clusters_count() const -> std::uint64_t;
+  [[nodiscard]] auto io_stats() const -> IOStats::Snapshot;
+  auto reset_io_stats() -> void;
+  [[nodiscard]] auto get_phase_latencies() const noexcept -> PhaseLatencies const &;
+  auto reset_phase_latencies() -> void;
 
   [[nodiscard]] auto dirname(std::string const &path) const -> std::string;
   [[nodiscard]] auto basename(std::string const &path) const -> std::string;
@@ -46,22 +135,55 @@ public:
   [[nodiscard]] auto get_writer(std::string const &path) -> FileWriter;
   [[nodiscard]] auto pwd() const -> std::string;
   [[nodiscard]] auto ls(std::string const &path) const -> std::vector<Metadata>;
+  // opens a cursor that reads a directory a chunk at a time; a names-only cursor leaves out the rest of the metadata.
+  // Each chunk takes the locks on its own, entries removed from the directory in between are skipped.
+  [[nodiscard]] auto readdir(std::string const &path, bool names_only = false,
+                             std::size_t chunk_size = READDIR_CHUNK_SIZE) const -> DirCursor;
   [[nodiscard]] auto stat(std::string const &path) const -> Metadata;
+  [[nodiscard]] auto du(std::string const &path) const -> DiskUsage;
   auto cd(std::string const &path) -> void;
-  auto cat(std::string const &path, std::ostream &out_stream) const -> void;
+  // writes the raw bytes of [offset, offset + length) clipped to the file, reading only the clusters of the range
+  auto cat(std::string const &path, std::ostream &out_stream, std::uint64_t offset = 0,
+           std::uint64_t length = std::numeric_limits<std::uint64_t>::max()) const -> void;
+  // writes the last count bytes of a file
+  auto tail(std::string const &path, std::ostream &out_stream, std::uint64_t count) const -> void;
   auto mkdir(std::string const &path) -> void;
   auto touch(std::string const &path) -> void;
   auto rmdir(std::string const &path) -> void;
   auto rm(std::string const &path, bool recursive = false) -> void;
-  auto cp(std::string const &source, std::string const &destination, bool recursive = false) -> void;
+  auto cp(std::string const &source, std::string const &destination, bool recursive = false, bool reflink = false,
+          std::size_t threads = 1) -> void;
   auto mv(std::string const &source, std::string const &destination, bool recursive = false) -> void;
   auto import_file(std::istream &in_stream, std::string const &path) -> void;
+  // imports a host directory tree, host files are read by the given number of threads
+  auto import_dir(std::string const &host_path, std::string const &path, std::size_t threads = 1) -> void;
   auto export_file(std::string const &path, std::ostream &out_stream) const -> void;
+  // exports a directory tree to a new host directory, files are written by the given number of threads
+  auto export_dir(std::string const &path, std::string const &host_path, std::size_t threads = 1) const -> void;
+  // export to and import from a host file by path; contiguous runs of clusters move inside the kernel where the
+  // platform allows it, and a failed copy leaves neither a partial host file nor a partial file in the image behind
+  auto export_to_host(std::string const &path, std::string const &host_path) const -> void;
+  auto import_from_host(std::string const &host_path, std::string const &path) -> void;
+  // a ustar stream unpacked into a new directory and a directory packed into one, both in a single pass
+  auto import_tar(std::istream &in_stream, std::string const &path) -> void;
+  auto export_tar(std::string const &path, std::ostream &out_stream) const -> void;
+  [[nodiscard]] auto read_file(std::string const &path) const -> std::vector<std::byte>;
+  auto write_file(std::string const &path, std::vector<std::byte> const &bytes, std::uint64_t offset = 0) -> void;
+
+  [[nodiscard]] auto async_read(std::string const &path) const -> std::future<std::vector<std::byte>>;
+  [[nodiscard]] auto async_write(std::string const &path, std::vector<std::byte> bytes, std::uint64_t offset = 0)
+      -> std::future<void>;
+  [[nodiscard]] auto async_import(std::shared_ptr<std::istream> in_stream, std::string const &path)
+      -> std::future<void>;
+  [[nodiscard]] auto async_cp(std::string const &source, std::string const &destination, bool recursive = false,
+                              bool reflink = false) -> std::future<void>;
 
   friend auto operator<<(std::ostream &out_stream, FileSystem const &file_system) -> std::ostream &;
 
 private:
-  [[nodiscard]] auto check_signature() -> bool;
+  [[nodiscard]] static auto open_disk(std::string const &path) -> std::shared_ptr<Disk>;
+  [[nodiscard]] auto detach() const -> FileSystem;
+  [[nodiscard]] auto read_signature() -> std::string;
   auto read_settings() -> void;
   [[nodiscard]] auto is_root_dir_created() noexcept -> bool;
   auto create_root_dir() -> void;
@@ -73,11 +195,74 @@ private:
   [[nodiscard]] auto does_file_exist(std::string const &path) const -> bool;
   [[nodiscard]] auto does_dir_exist(std::string const &path) const -> bool;
   [[nodiscard]] auto alloc_new_dir(std::string const &name, std::uint64_t parent_cluster) -> std::uint64_t;
+  auto make_dir(std::string const &path) -> void;
+  [[nodiscard]] auto make_file(std::string const &path) -> std::optional<std::uint64_t>;
+  [[nodiscard]] auto make_import_target(std::string const &path) -> std::uint64_t;
+  auto remove_dir(std::string const &path) -> void;
   auto add_file_to_dir(std::uint64_t parent_cluster, std::uint64_t child_cluster) const -> void;
   auto remove_file_from_dir(std::uint64_t parent_cluster, std::uint64_t child_cluster) -> void;
+  [[nodiscard]] auto calculate_clusters_count(std::uint64_t file_size) const noexcept -> std::uint64_t;
   auto overwrite_file(std::uint64_t cluster, Metadata old_meta, std::vector<std::byte> const &bytes) -> void;
   auto rmfile(std::string const &path) -> void;
   auto rm_recursive(std::string const &path) -> void;
-  auto shallow_copy(std::string const &source, std::string const &destination) -> void;
-  auto deep_copy(std::string const &source, std::string const &destination) -> void;
+  auto shallow_copy(std::string const &source, std::string const &destination, bool reflink) -> void;
+  auto deep_copy(std::string const &source, std::string const &destination, bool reflink, std::size_t threads = 1)
+      -> void;
+  [[nodiscard]] auto copy_file_data(Metadata const &source_meta, std::string const &name, std::uint64_t parent_cluster,
+                                    bool reflink) -> std::uint64_t;
+  [[nodiscard]] auto prepare_copy(Metadata const &source_meta, std::string const &name, std::uint64_t parent_cluster)
+      -> CopyJob;
+  static auto run_copy_job(HandlerBuilder const &handler_builder, CopyJob const &copy_job) -> void;
+  auto run_copy_jobs(std::vector<CopyJob> const &copy_jobs, std::size_t threads) const -> void;
+  [[nodiscard]] auto prepare_import_dir(std::filesystem::path const &host_path, std::string const &name,
+                                        std::uint64_t parent_cluster, std::vector<ImportJob> &import_jobs,
+                                        std::vector<std::uint64_t> &dir_clusters) -> std::uint64_t;
+  [[nodiscard]] auto prepare_import(std::filesystem::path const &host_path, std::string const &name,
+                                    std::uint64_t parent_cluster) -> ImportJob;
+  auto read_host_file(ImportJob const &import_job,
+                      std::function<void(std::size_t, std::vector<std::byte>)> const &on_block) const -> void;
+  auto run_import_jobs(std::vector<ImportJob> const &import_jobs, std::size_t threads) const -> void;
+  auto run_export_job(ExportJob const &export_job) const -> void;
+  [[nodiscard]] auto get_data_extents(std::uint64_t cluster, std::uint64_t size) const -> std::vector<Extent>;
+  auto copy_to_host(std::uint64_t cluster, std::uint64_t size, HostFile &host_file) const -> void;
+  auto write_range(std::uint64_t cluster, std::uint64_t begin, std::uint64_t end, std::ostream &out_stream) const
+      -> void;
+  auto copy_from_host(HostFile &host_file, std::uint64_t cluster, std::uint64_t size) -> void;
+  auto write_stream(std::istream &in_stream, Metadata const &meta, std::vector<std::uint64_t> const &clusters) const
+      -> void;
+  [[nodiscard]] auto get_batch_size() const noexcept -> std::uint64_t;
+  auto write_to_chain(std::vector<std::uint64_t> const &clusters, std::size_t first_cluster,
+                      std::vector<std::byte> const &bytes) const -> void;
+  auto run_export_jobs(std::vector<ExportJob> const &export_jobs, std::size_t threads) const -> void;
+};
+
+struct FileSystem::CopyJob {
+  std::uint64_t source_cluster;
+  std::vector<std::uint64_t> destination_clusters;
+  Metadata destination_meta;
+};
+
+struct FileSystem::ExportJob {
+  std::uint64_t cluster;
+  std::filesystem::path host_path;
+};
+
+// a piece of a file's data that sits in one contiguous run of clusters
+struct FileSystem::Extent {
+  std::uint64_t offset; // in the image
+  std::uint64_t file_offset;
+  std::uint64_t size;
+};
+
+struct FileSystem::ImportJob {
+  std::filesystem::path host_path;
+  std::vector<std::uint64_t> destination_clusters;
+  Metadata destination_meta;
+};
+
+// a batch of whole clusters of an imported file, the first one carries the header
+struct FileSystem::ImportBlock {
+  std::size_t job;
+  std::size_t first_cluster; // index in the destination chain
+  std::vector<std::byte> bytes;
 };
\ No newline at end of file
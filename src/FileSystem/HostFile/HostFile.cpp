@@ -0,0 +1,85 @@
+#include "HostFile.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+
+HostFile::HostFile(std::filesystem::path const &path, bool for_writing)
+    : stream_(path, std::ios::binary | (for_writing ? std::ios::out | std::ios::trunc : std::ios::in)) {
+  if (!stream_.is_open()) throw std::runtime_error("Cannot open file " + path.string());
+}
+
+HostFile::~HostFile() = default;
+
+auto HostFile::get_fd() const noexcept -> int { return -1; }
+
+auto HostFile::get_size() -> std::uint64_t {
+  auto position = stream_.tellg();
+  stream_.seekg(0, std::ios::end);
+  auto size = static_cast<std::uint64_t>(stream_.tellg());
+  stream_.seekg(position);
+  return size;
+}
+
+auto HostFile::read(std::uint64_t size) -> std::vector<std::byte> {
+  std::vector<std::byte> bytes(size);
+  stream_.read(reinterpret_cast<char *>(bytes.data()), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+               static_cast<std::streamsize>(size));
+  bytes.resize(static_cast<std::size_t>(stream_.gcount()));
+  return bytes;
+}
+
+auto HostFile::write(std::vector<std::byte> const &bytes) -> void {
+  stream_.write(reinterpret_cast<char const *>(bytes.data()), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                static_cast<std::streamsize>(bytes.size()));
+  if (!stream_) throw std::runtime_error("Cannot write to host file");
+}
+
+#else
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+HostFile::HostFile(std::filesystem::path const &path, bool for_writing)
+    : fd_(for_writing ? ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) // NOLINT
+                      : ::open(path.c_str(), O_RDONLY | O_CLOEXEC)) {                        // NOLINT
+  if (fd_ < 0) throw std::runtime_error("Cannot open file " + path.string());
+}
+
+HostFile::~HostFile() { ::close(fd_); }
+
+auto HostFile::get_fd() const noexcept -> int { return fd_; }
+
+auto HostFile::get_size() -> std::uint64_t {
+  struct stat file_stat {};
+  if (::fstat(fd_, &file_stat) != 0) throw std::runtime_error("Cannot stat host file");
+  return static_cast<std::uint64_t>(file_stat.st_size);
+}
+
+auto HostFile::read(std::uint64_t size) -> std::vector<std::byte> {
+  std::vector<std::byte> bytes(size);
+  std::uint64_t read_count = 0;
+  while (read_count < size) {
+    auto result = ::read(fd_, bytes.data() + read_count, size - read_count);
+    if (result < 0 && errno == EINTR) continue;
+    if (result < 0) throw std::runtime_error("Cannot read from host file");
+    if (result == 0) break;
+    read_count += static_cast<std::uint64_t>(result);
+  }
+  bytes.resize(read_count);
+  return bytes;
+}
+
+auto HostFile::write(std::vector<std::byte> const &bytes) -> void {
+  std::uint64_t written_count = 0;
+  while (written_count < bytes.size()) {
+    auto result = ::write(fd_, bytes.data() + written_count, bytes.size() - written_count);
+    if (result < 0 && errno == EINTR) continue;
+    if (result < 0) throw std::runtime_error("Cannot write to host file");
+    written_count += static_cast<std::uint64_t>(result);
+  }
+}
+
+#endif
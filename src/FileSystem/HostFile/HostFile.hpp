@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+// A file on the host, opened for reading or truncated for writing. On POSIX the bytes go straight through the
+// descriptor, without stream buffering in between, and the descriptor can be handed to kernel copies; Windows
+// falls back to an fstream and has no descriptor.
+class HostFile {
+#ifdef _WIN32
+  std::fstream stream_;
+#else
+  int fd_;
+#endif
+
+public:
+  explicit HostFile(std::filesystem::path const &path, bool for_writing = true);
+  HostFile(HostFile const &) = delete;
+  HostFile(HostFile &&) = delete;
+
+  ~HostFile();
+
+  auto operator=(HostFile const &) -> HostFile & = delete;
+  auto operator=(HostFile &&) -> HostFile & = delete;
+
+  [[nodiscard]] auto get_fd() const noexcept -> int; // -1 without a descriptor
+  [[nodiscard]] auto get_size() -> std::uint64_t;
+
+  // sequential from the start of the file; a read comes back short at the end of the file
+  [[nodiscard]] auto read(std::uint64_t size) -> std::vector<std::byte>;
+  auto write(std::vector<std::byte> const &bytes) -> void;
+};
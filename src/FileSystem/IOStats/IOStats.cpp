@@ -0,0 +1,84 @@
+#include "IOStats.hpp"
+
+auto IOStats::Snapshot::total() const noexcept -> Counters {
+  Counters counters;
+  for (auto const *region : {&superblock, &fat, &data}) {
+    counters.reads += region->reads;
+    counters.read_bytes += region->read_bytes;
+    counters.writes += region->writes;
+    counters.written_bytes += region->written_bytes;
+    counters.seeks += region->seeks;
+  }
+  return counters;
+}
+
+IOStats::IOStats(std::uint64_t fat_offset, std::uint64_t data_offset)
+    : fat_offset_(fat_offset), data_offset_(data_offset) {}
+
+auto IOStats::record_read(std::uint64_t offset, std::uint64_t size) noexcept -> void {
+  auto &region = get_region(offset);
+  region.reads.fetch_add(1, std::memory_order_relaxed);
+  region.read_bytes.fetch_add(size, std::memory_order_relaxed);
+  record_seek(region, offset, size);
+}
+
+auto IOStats::record_write(std::uint64_t offset, std::uint64_t size) noexcept -> void {
+  auto &region = get_region(offset);
+  region.writes.fetch_add(1, std::memory_order_relaxed);
+  region.written_bytes.fetch_add(size, std::memory_order_relaxed);
+  record_seek(region, offset, size);
+}
+
+auto IOStats::record_flush() noexcept -> void { flushes_.fetch_add(1, std::memory_order_relaxed); }
+
+auto IOStats::snapshot() const noexcept -> Snapshot {
+  return {load(superblock_), load(fat_), load(data_), flushes_.load(std::memory_order_relaxed)};
+}
+
+auto IOStats::reset() noexcept -> void {
+  clear(superblock_);
+  clear(fat_);
+  clear(data_);
+  flushes_.store(0, std::memory_order_relaxed);
+}
+
+auto IOStats::to_string(Snapshot const &snapshot) -> std::string {
+  std::stringstream stream;
+  stream << "I/O:\n";
+  auto print = [&stream](std::string const &name, Counters const &counters) {
+    stream << "    " << name << ": " << counters.reads << " reads (" << counters.read_bytes << " B), "
+           << counters.writes << " writes (" << counters.written_bytes << " B), " << counters.seeks << " seeks\n";
+  };
+  print("Superblock", snapshot.superblock);
+  print("FAT", snapshot.fat);
+  print("Data", snapshot.data);
+  print("Total", snapshot.total());
+  stream << "    Flushes: " << snapshot.flushes << '\n';
+  return stream.str();
+}
+
+auto IOStats::get_region(std::uint64_t offset) noexcept -> AtomicCounters & {
+  if (offset < fat_offset_) return superblock_;
+  if (offset < data_offset_) return fat_;
+  return data_;
+}
+
+auto IOStats::record_seek(AtomicCounters &region, std::uint64_t offset, std::uint64_t size) noexcept -> void {
+  if (position_.exchange(offset + size, std::memory_order_relaxed) != offset) {
+    region.seeks.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+auto IOStats::load(AtomicCounters const &counters) noexcept -> Counters {
+  return {counters.reads.load(std::memory_order_relaxed), counters.read_bytes.load(std::memory_order_relaxed),
+          counters.writes.load(std::memory_order_relaxed), counters.written_bytes.load(std::memory_order_relaxed),
+          counters.seeks.load(std::memory_order_relaxed)};
+}
+
+auto IOStats::clear(AtomicCounters &counters) noexcept -> void {
+  counters.reads.store(0, std::memory_order_relaxed);
+  counters.read_bytes.store(0, std::memory_order_relaxed);
+  counters.writes.store(0, std::memory_order_relaxed);
+  counters.written_bytes.store(0, std::memory_order_relaxed);
+  counters.seeks.store(0, std::memory_order_relaxed);
+}
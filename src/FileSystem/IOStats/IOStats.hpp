@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// Counts the requests disk readers and writers make, split by the region of the image they start in: the
+// superblock (signature and settings), the FAT with its reference counts, and the data clusters. A seek is a
+// request that does not start where the previous one ended. Counters are relaxed atomics, shared by every
+// handler of one file system.
+class IOStats {
+public:
+  struct Counters {
+    std::uint64_t reads = 0;
+    std::uint64_t read_bytes = 0;
+    std::uint64_t writes = 0;
+    std::uint64_t written_bytes = 0;
+    std::uint64_t seeks = 0;
+  };
+
+  struct Snapshot {
+    Counters superblock;
+    Counters fat;
+    Counters data;
+    std::uint64_t flushes = 0; // batches the write-combining layer sent to the image
+
+    [[nodiscard]] auto total() const noexcept -> Counters;
+  };
+
+private:
+  struct AtomicCounters {
+    std::atomic<std::uint64_t> reads = 0;
+    std::atomic<std::uint64_t> read_bytes = 0;
+    std::atomic<std::uint64_t> writes = 0;
+    std::atomic<std::uint64_t> written_bytes = 0;
+    std::atomic<std::uint64_t> seeks = 0;
+  };
+
+  std::uint64_t fat_offset_;
+  std::uint64_t data_offset_;
+
+  AtomicCounters superblock_;
+  AtomicCounters fat_;
+  AtomicCounters data_;
+  std::atomic<std::uint64_t> flushes_ = 0;
+  std::atomic<std::uint64_t> position_ = 0;
+
+public:
+  IOStats(std::uint64_t fat_offset, std::uint64_t data_offset);
+
+  auto record_read(std::uint64_t offset, std::uint64_t size) noexcept -> void;
+  auto record_write(std::uint64_t offset, std::uint64_t size) noexcept -> void;
+  auto record_flush() noexcept -> void;
+
+  [[nodiscard]] auto snapshot() const noexcept -> Snapshot;
+  auto reset() noexcept -> void;
+
+  static auto to_string(Snapshot const &snapshot) -> std::string;
+
+private:
+  [[nodiscard]] auto get_region(std::uint64_t offset) noexcept -> AtomicCounters &;
+  auto record_seek(AtomicCounters &region, std::uint64_t offset, std::uint64_t size) noexcept -> void;
+  static auto load(AtomicCounters const &counters) noexcept -> Counters;
+  static auto clear(AtomicCounters &counters) noexcept -> void;
+};
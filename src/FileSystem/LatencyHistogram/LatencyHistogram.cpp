@@ -0,0 +1,87 @@
+#include "LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+auto LatencyHistogram::record(std::chrono::nanoseconds latency) noexcept -> void {
+  auto value = static_cast<std::uint64_t>(std::max<std::int64_t>(latency.count(), 0));
+  buckets_[get_bucket(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+
+  auto max = max_.load(std::memory_order_relaxed);
+  while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+auto LatencyHistogram::get_count() const noexcept -> std::uint64_t { return count_.load(std::memory_order_relaxed); }
+
+auto LatencyHistogram::percentile(double fraction) const noexcept -> std::chrono::nanoseconds {
+  auto count = get_count();
+  if (count == 0) return std::chrono::nanoseconds(0);
+
+  // the smallest bucket that covers the requested share of the samples, reported by its upper bound
+  auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(count))));
+  std::uint64_t seen = 0;
+  for (std::size_t bucket = 0; bucket < BUCKETS_COUNT; ++bucket) {
+    seen += buckets_[bucket].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      auto bound = std::min(get_upper_bound(bucket), max_.load(std::memory_order_relaxed));
+      return std::chrono::nanoseconds(static_cast<std::int64_t>(bound));
+    }
+  }
+  return std::chrono::nanoseconds(static_cast<std::int64_t>(max_.load(std::memory_order_relaxed)));
+}
+
+auto LatencyHistogram::summary() const noexcept -> Summary {
+  return {get_count(), percentile(0.5), percentile(0.99),
+          std::chrono::nanoseconds(static_cast<std::int64_t>(max_.load(std::memory_order_relaxed)))};
+}
+
+auto LatencyHistogram::reset() noexcept -> void {
+  for (auto &bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+  count_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::dump(std::string const &name, std::ostream &out_stream) const -> void {
+  for (std::size_t bucket = 0; bucket < BUCKETS_COUNT; ++bucket) {
+    auto count = buckets_[bucket].load(std::memory_order_relaxed);
+    if (count == 0) continue;
+    out_stream << name << ',' << get_lower_bound(bucket) << ',' << get_upper_bound(bucket) << ',' << count << '\n';
+  }
+}
+
+auto LatencyHistogram::to_string(Summary const &summary) -> std::string {
+  auto micros = [](std::chrono::nanoseconds value) {
+    std::stringstream stream;
+    stream << std::fixed << std::setprecision(1) << static_cast<double>(value.count()) / 1000.0 << "us";
+    return stream.str();
+  };
+
+  std::stringstream stream;
+  stream << summary.count << " calls, p50 " << micros(summary.p50) << ", p99 " << micros(summary.p99) << ", max "
+         << micros(summary.max);
+  return stream.str();
+}
+
+auto LatencyHistogram::get_bucket(std::uint64_t value) noexcept -> std::size_t {
+  if (value < SUB_BUCKETS) return value;
+  auto exponent = static_cast<std::uint64_t>(std::bit_width(value)) - 1;
+  auto sub_bucket = (value >> (exponent - SUB_BUCKET_BITS)) - SUB_BUCKETS;
+  return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + sub_bucket;
+}
+
+auto LatencyHistogram::get_lower_bound(std::size_t bucket) noexcept -> std::uint64_t {
+  if (bucket < SUB_BUCKETS) return bucket;
+  auto shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+  auto sub_bucket = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+  return (SUB_BUCKETS + sub_bucket) << shift;
+}
+
+auto LatencyHistogram::get_upper_bound(std::size_t bucket) noexcept -> std::uint64_t {
+  if (bucket < SUB_BUCKETS) return bucket;
+  auto shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+  return get_lower_bound(bucket) + ((std::uint64_t{1} << shift) - 1);
+}
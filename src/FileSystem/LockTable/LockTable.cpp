@@ -0,0 +1,5 @@
+#include "LockTable.hpp"
+
+LockTable::LockTable(std::size_t stripes_count) : stripes_(stripes_count == 0 ? 1 : stripes_count) {}
+
+auto LockTable::get(std::uint64_t cluster) -> std::shared_mutex & { return stripes_[cluster % stripes_.size()]; }
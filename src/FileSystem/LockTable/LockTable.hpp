@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+
+// Reader-writer locks for files and directories, striped by first cluster so the table has a fixed size.
+// Two clusters may share a stripe, so a thread must never hold more than one of these locks at a time.
+class LockTable {
+  static const std::size_t DEFAULT_STRIPES_COUNT = 64;
+
+  std::vector<std::shared_mutex> stripes_;
+
+public:
+  explicit LockTable(std::size_t stripes_count = DEFAULT_STRIPES_COUNT);
+
+  [[nodiscard]] auto get(std::uint64_t cluster) -> std::shared_mutex &;
+};
@@ -0,0 +1,233 @@
+#include "Tar.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+// field offsets of the ustar header
+const std::size_t NAME_OFFSET = 0;
+const std::size_t MODE_OFFSET = 100;
+const std::size_t SIZE_OFFSET = 124;
+const std::size_t MTIME_OFFSET = 136;
+const std::size_t CHECKSUM_OFFSET = 148;
+const std::size_t TYPE_OFFSET = 156;
+const std::size_t MAGIC_OFFSET = 257;
+const std::size_t VERSION_OFFSET = 263;
+const std::size_t PREFIX_OFFSET = 345;
+
+const std::size_t MODE_SIZE = 8;
+const std::size_t SIZE_SIZE = 12;
+const std::size_t MTIME_SIZE = 12;
+const std::size_t CHECKSUM_SIZE = 8;
+const std::size_t MAGIC_SIZE = 6;
+
+const std::uint64_t FILE_MODE = 0644;
+const std::uint64_t DIRECTORY_MODE = 0755;
+} // namespace
+
+auto Tar::write_header(std::ostream &out_stream, Header const &header) -> void {
+  auto block = to_bytes(header);
+  out_stream.write(block.data(), static_cast<std::streamsize>(block.size()));
+}
+
+auto Tar::write_padding(std::ostream &out_stream, std::uint64_t size) -> void {
+  std::array<char, BLOCK_SIZE> zeros{};
+  out_stream.write(zeros.data(), static_cast<std::streamsize>(get_padding(size)));
+}
+
+auto Tar::write_end(std::ostream &out_stream) -> void {
+  std::array<char, BLOCK_SIZE> zeros{};
+  out_stream.write(zeros.data(), zeros.size());
+  out_stream.write(zeros.data(), zeros.size());
+  out_stream.flush();
+}
+
+auto Tar::read_header(std::istream &in_stream) -> std::optional<Header> {
+  std::array<char, BLOCK_SIZE> block{};
+  in_stream.read(block.data(), block.size());
+  if (in_stream.gcount() == 0) return std::nullopt; // archives cut after the first zero block are accepted too
+  if (in_stream.gcount() != static_cast<std::streamsize>(BLOCK_SIZE)) {
+    throw std::invalid_argument("Unexpected end of tar stream");
+  }
+
+  if (std::all_of(block.begin(), block.end(), [](char byte) { return byte == 0; })) return std::nullopt;
+  return from_bytes(block);
+}
+
+auto Tar::read_entry(std::istream &in_stream) -> std::optional<Header> {
+  std::optional<std::string> long_name;
+  std::string pax_records;
+  for (auto header = read_header(in_stream); header.has_value(); header = read_header(in_stream)) {
+    if (header->type == TypeOptions::LONG_NAME) {
+      auto name = read_extended(in_stream, header->size);
+      long_name = normalize_path(name.substr(0, name.find('\0')));
+      continue;
+    }
+    if (header->type == TypeOptions::PAX_HEADER) {
+      pax_records = read_extended(in_stream, header->size);
+      continue;
+    }
+
+    // pax records win over a GNU long name, as in GNU tar
+    if (long_name.has_value()) header->path = long_name.value();
+    apply_pax_records(pax_records, header.value());
+    return header;
+  }
+  if (long_name.has_value() || !pax_records.empty()) throw std::invalid_argument("Unexpected end of tar stream");
+  return std::nullopt;
+}
+
+auto Tar::skip(std::istream &in_stream, std::uint64_t size) -> void {
+  std::array<char, BLOCK_SIZE> buffer{};
+  while (size > 0) {
+    auto count = std::min<std::uint64_t>(size, buffer.size());
+    in_stream.read(buffer.data(), static_cast<std::streamsize>(count));
+    if (in_stream.gcount() != static_cast<std::streamsize>(count)) {
+      throw std::invalid_argument("Unexpected end of tar stream");
+    }
+    size -= count;
+  }
+}
+
+auto Tar::skip_padding(std::istream &in_stream, std::uint64_t size) -> void { skip(in_stream, get_padding(size)); }
+
+auto Tar::to_bytes(Header const &header) -> std::array<char, BLOCK_SIZE> {
+  if (header.size > MAX_SIZE) throw std::invalid_argument("File too large for tar: " + header.path);
+
+  // long paths are split at a slash into the prefix and name fields
+  auto path = header.type == TypeOptions::DIRECTORY ? header.path + "/" : header.path;
+  std::string prefix;
+  std::string name = path;
+  if (path.size() > NAME_SIZE) {
+    auto split = path.rfind('/', PREFIX_SIZE);
+    if (split != std::string::npos && path.size() - split - 1 > NAME_SIZE) split = std::string::npos;
+    if (split == std::string::npos || split == 0) throw std::invalid_argument("Path too long for tar: " + header.path);
+    prefix = path.substr(0, split);
+    name = path.substr(split + 1);
+  }
+
+  std::array<char, BLOCK_SIZE> block{};
+  std::copy(name.begin(), name.end(), block.begin() + NAME_OFFSET);
+  std::copy(prefix.begin(), prefix.end(), block.begin() + PREFIX_OFFSET);
+  write_octal(&block[MODE_OFFSET], MODE_SIZE, header.type == TypeOptions::DIRECTORY ? DIRECTORY_MODE : FILE_MODE);
+  write_octal(&block[SIZE_OFFSET], SIZE_SIZE, header.size);
+  write_octal(&block[MTIME_OFFSET], MTIME_SIZE, 0); // the file system keeps no times
+  block[TYPE_OFFSET] = header.type;
+  std::string const magic = "ustar";
+  std::copy(magic.begin(), magic.end(), block.begin() + MAGIC_OFFSET);
+  block[VERSION_OFFSET] = '0';
+  block[VERSION_OFFSET + 1] = '0';
+
+  // the checksum is computed with its own field filled with spaces, then stored as six digits, NUL and space
+  std::fill_n(block.begin() + CHECKSUM_OFFSET, CHECKSUM_SIZE, ' ');
+  write_octal(&block[CHECKSUM_OFFSET], CHECKSUM_SIZE - 1, calculate_checksum(block));
+  return block;
+}
+
+auto Tar::from_bytes(std::array<char, BLOCK_SIZE> const &block) -> Header {
+  // "ustar\0" is POSIX, "ustar " is what GNU tar writes
+  if (read_string(&block[MAGIC_OFFSET], MAGIC_SIZE - 1) != "ustar") {
+    throw std::invalid_argument("Not a ustar header");
+  }
+  if (read_octal(&block[CHECKSUM_OFFSET], CHECKSUM_SIZE) != calculate_checksum(block)) {
+    throw std::invalid_argument("Invalid tar header checksum");
+  }
+
+  auto name = read_string(&block[NAME_OFFSET], NAME_SIZE);
+  auto prefix = read_string(&block[PREFIX_OFFSET], PREFIX_SIZE);
+  auto path = normalize_path(prefix.empty() ? name : prefix + "/" + name);
+  return {path, read_octal(&block[SIZE_OFFSET], SIZE_SIZE), block[TYPE_OFFSET]};
+}
+
+auto Tar::get_padding(std::uint64_t size) noexcept -> std::uint64_t {
+  return (BLOCK_SIZE - size % BLOCK_SIZE) % BLOCK_SIZE;
+}
+
+auto Tar::calculate_checksum(std::array<char, BLOCK_SIZE> const &block) noexcept -> std::uint64_t {
+  std::uint64_t checksum = 0;
+  for (std::size_t i = 0; i < block.size(); ++i) {
+    auto is_checksum_field = i >= CHECKSUM_OFFSET && i < CHECKSUM_OFFSET + CHECKSUM_SIZE;
+    checksum += is_checksum_field ? static_cast<unsigned char>(' ') : static_cast<unsigned char>(block.at(i));
+  }
+  return checksum;
+}
+
+auto Tar::write_octal(char *field, std::size_t field_size, std::uint64_t value) -> void {
+  // right aligned, zero padded and NUL terminated
+  field[field_size - 1] = '\0'; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  for (auto i = static_cast<std::int64_t>(field_size) - 2; i >= 0; --i) {
+    field[i] = static_cast<char>('0' + (value & 07)); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    value >>= 3;
+  }
+  if (value != 0) throw std::invalid_argument("Value does not fit the tar header");
+}
+
+auto Tar::read_octal(char const *field, std::size_t field_size) -> std::uint64_t {
+  // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  std::uint64_t value = 0;
+  std::size_t i = 0;
+  while (i < field_size && field[i] == ' ') ++i;
+  for (; i < field_size && field[i] >= '0' && field[i] <= '7'; ++i) {
+    value = (value << 3) | static_cast<std::uint64_t>(field[i] - '0');
+  }
+  auto is_terminated = i == field_size || field[i] == '\0' || field[i] == ' ';
+  // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  if (!is_terminated) throw std::invalid_argument("Invalid number in tar header");
+  return value;
+}
+
+auto Tar::read_string(char const *field, std::size_t field_size) -> std::string {
+  std::string value(field, field_size);
+  auto end = value.find('\0');
+  if (end != std::string::npos) value.resize(end);
+  return value;
+}
+
+auto Tar::read_extended(std::istream &in_stream, std::uint64_t size) -> std::string {
+  if (size > MAX_EXTENDED_SIZE) throw std::invalid_argument("Extended tar header too large");
+  std::string data(size, '\0');
+  in_stream.read(data.data(), static_cast<std::streamsize>(size));
+  if (in_stream.gcount() != static_cast<std::streamsize>(size)) {
+    throw std::invalid_argument("Unexpected end of tar stream");
+  }
+  skip_padding(in_stream, size);
+  return data;
+}
+
+auto Tar::apply_pax_records(std::string const &records, Header &header) -> void {
+  // every record counts its own length, digits and newline included; keys other than path and size are ignored
+  std::size_t position = 0;
+  while (position < records.size()) {
+    auto space = records.find(' ', position);
+    if (space == std::string::npos) throw std::invalid_argument("Invalid pax record");
+    auto length = parse_decimal(records.substr(position, space - position));
+    if (length <= space - position + 1 || length > records.size() - position ||
+        records[position + length - 1] != '\n') {
+      throw std::invalid_argument("Invalid pax record");
+    }
+
+    auto record = records.substr(space + 1, position + length - space - 2);
+    position += length;
+    auto equals = record.find('=');
+    if (equals == std::string::npos) throw std::invalid_argument("Invalid pax record");
+    auto key = record.substr(0, equals);
+    auto value = record.substr(equals + 1);
+    if (key == "path") header.path = normalize_path(value);
+    if (key == "size") header.size = parse_decimal(value);
+  }
+}
+
+auto Tar::parse_decimal(std::string const &value) -> std::uint64_t {
+  std::uint64_t number = 0;
+  auto const *end = value.data() + value.size(); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  auto [last, error] = std::from_chars(value.data(), end, number);
+  if (value.empty() || error != std::errc() || last != end) throw std::invalid_argument("Invalid pax record");
+  return number;
+}
+
+auto Tar::normalize_path(std::string path) -> std::string {
+  while (path.starts_with("./")) path.erase(0, 2);
+  while (path.ends_with('/')) path.pop_back();
+  return path;
+}
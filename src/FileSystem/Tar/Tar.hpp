@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// POSIX ustar archives: every entry is a 512 byte header followed by its data padded to whole blocks, and the archive
+// ends with two zero blocks. Only the fields the file system has are written, the rest is zero; when reading,
+// GNU long names and pax path and size records are applied to the entry they precede, and entries of other types
+// than files and directories are reported as they are, so the caller can skip them.
+class Tar {
+  static const std::uint64_t NAME_SIZE = 100;
+  static const std::uint64_t PREFIX_SIZE = 155;
+  static const std::uint64_t MAX_SIZE = 077777777777; // 11 octal digits
+  static const std::uint64_t MAX_EXTENDED_SIZE = 1024 * 1024; // long names and pax records are read into memory
+
+public:
+  static const std::uint64_t BLOCK_SIZE = 512;
+
+  struct TypeOptions;
+
+  struct Header {
+    std::string path; // relative, without a trailing slash
+    std::uint64_t size;
+    char type;
+  };
+
+  static auto write_header(std::ostream &out_stream, Header const &header) -> void;
+  // writes the zero bytes that complete the last block of an entry's data
+  static auto write_padding(std::ostream &out_stream, std::uint64_t size) -> void;
+  static auto write_end(std::ostream &out_stream) -> void;
+
+  // nullopt at the end of the archive
+  [[nodiscard]] static auto read_header(std::istream &in_stream) -> std::optional<Header>;
+  // the next header that is not a long name or a pax record, with those applied to it
+  [[nodiscard]] static auto read_entry(std::istream &in_stream) -> std::optional<Header>;
+  static auto skip(std::istream &in_stream, std::uint64_t size) -> void;
+  static auto skip_padding(std::istream &in_stream, std::uint64_t size) -> void;
+
+  [[nodiscard]] static auto to_bytes(Header const &header) -> std::array<char, BLOCK_SIZE>;
+  [[nodiscard]] static auto from_bytes(std::array<char, BLOCK_SIZE> const &block) -> Header;
+
+private:
+  [[nodiscard]] static auto get_padding(std::uint64_t size) noexcept -> std::uint64_t;
+  [[nodiscard]] static auto calculate_checksum(std::array<char, BLOCK_SIZE> const &block) noexcept -> std::uint64_t;
+  static auto write_octal(char *field, std::size_t field_size, std::uint64_t value) -> void;
+  [[nodiscard]] static auto read_octal(char const *field, std::size_t field_size) -> std::uint64_t;
+  [[nodiscard]] static auto read_string(char const *field, std::size_t field_size) -> std::string;
+  [[nodiscard]] static auto read_extended(std::istream &in_stream, std::uint64_t size) -> std::string;
+  static auto apply_pax_records(std::string const &records, Header &header) -> void;
+  [[nodiscard]] static auto parse_decimal(std::string const &value) -> std::uint64_t;
+  [[nodiscard]] static auto normalize_path(std::string path) -> std::string;
+};
+
+struct Tar::TypeOptions {
+  static const char FILE = '0';
+  static const char OLD_FILE = '\0';
+  static const char DIRECTORY = '5';
+  static const char LONG_NAME = 'L';  // GNU: the data is the path of the next entry
+  static const char PAX_HEADER = 'x'; // pax: "length key=value\n" records for the next entry
+};
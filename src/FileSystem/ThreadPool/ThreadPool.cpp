@@ -0,0 +1,41 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(std::size_t threads_count) : threads_count_(threads_count == 0 ? 1 : threads_count) {}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  for (auto &worker : workers_) worker.join();
+}
+
+auto ThreadPool::get_threads_count() const noexcept -> std::size_t { return threads_count_; }
+
+auto ThreadPool::enqueue(std::function<void()> task) -> void {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push(std::move(task));
+
+    if (workers_.empty()) {
+      workers_.reserve(threads_count_);
+      for (std::size_t i = 0; i < threads_count_; ++i) workers_.emplace_back(&ThreadPool::work, this);
+    }
+  }
+  condition_.notify_one();
+}
+
+auto ThreadPool::work() -> void {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) return; // stopping and drained
+      task = std::move(tasks_.front());
+      tasks_.pop();
+    }
+    task(); // packaged tasks store exceptions in their futures
+  }
+}
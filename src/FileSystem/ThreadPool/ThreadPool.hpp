@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size pool of worker threads, started on the first submitted task.
+// Destroying the pool runs every task that is still queued and joins the workers.
+class ThreadPool {
+  std::size_t threads_count_;
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool stopping_ = false;
+
+public:
+  explicit ThreadPool(std::size_t threads_count);
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool(ThreadPool &&) = delete;
+
+  ~ThreadPool();
+  auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+  auto operator=(ThreadPool &&) -> ThreadPool & = delete;
+
+  [[nodiscard]] auto get_threads_count() const noexcept -> std::size_t;
+
+  template <typename Task> [[nodiscard]] auto submit(Task task) -> std::future<std::invoke_result_t<Task>> {
+    using Result = std::invoke_result_t<Task>;
+
+    // std::function needs a copyable target, the packaged task is shared with the queued wrapper
+    auto packaged_task = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    auto future = packaged_task->get_future();
+    enqueue([packaged_task]() { (*packaged_task)(); });
+    return future;
+  }
+
+private:
+  auto enqueue(std::function<void()> task) -> void;
+  auto work() -> void;
+};
@@ -0,0 +1,49 @@
+#include "TreeWalker.hpp"
+
+#include <mutex>
+
+TreeWalker::TreeWalker(HandlerBuilder handler_builder, std::shared_ptr<LockTable> inode_locks)
+    : handler_builder_(std::move(handler_builder)), inode_locks_(std::move(inode_locks)) {}
+
+auto TreeWalker::walk(std::uint64_t root_cluster, Visitor const &pre_order, Visitor const &post_order) const
+    -> void {
+  std::vector<Frame> stack;
+
+  auto visit = [&](Metadata meta) {
+    if (pre_order) pre_order(meta);
+    if (meta.is_directory()) {
+      auto children = read_children(meta);
+      stack.push_back(Frame{std::move(meta), std::move(children), 0});
+      return;
+    }
+    if (post_order) post_order(meta);
+  };
+
+  visit(read_metadata(root_cluster));
+  while (!stack.empty()) {
+    auto &frame = stack.back();
+    if (frame.next_child < frame.children.size()) {
+      auto child_meta = frame.children[frame.next_child++];
+      visit(std::move(child_meta)); // may reallocate the stack, frame is not used afterwards
+      continue;
+    }
+
+    auto meta = std::move(frame.meta);
+    stack.pop_back();
+    if (post_order) post_order(meta);
+  }
+}
+
+auto TreeWalker::read_metadata(std::uint64_t cluster) const -> Metadata {
+  return handler_builder_.build_metadata_handler(cluster).read_metadata();
+}
+
+auto TreeWalker::read_children(Metadata const &dir_meta) const -> std::vector<Metadata> {
+  // the size is already known from the header, so the listing is read without another metadata round-trip, and the
+  // headers of all children are fetched in one batch when the directory is entered
+  std::shared_lock<std::shared_mutex> dir_lock;
+  if (inode_locks_) dir_lock = std::shared_lock(inode_locks_->get(dir_meta.get_first_cluster()));
+  auto byte_reader = handler_builder_.build_byte_reader(dir_meta.get_first_cluster());
+  auto bytes = byte_reader.read_bytes(Metadata::get_metadata_size(), dir_meta.get_size());
+  return handler_builder_.read_metadata_batch(Directory::from_bytes(bytes).list_files());
+}
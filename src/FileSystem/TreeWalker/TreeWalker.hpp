@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../Directory/Directory.hpp"
+#include "../FileHandler/HandlerBuilder/HandlerBuilder.hpp"
+#include "../LockTable/LockTable.hpp"
+#include "../Metadata/Metadata.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Visits a tree depth first. With a lock table, every directory is locked shared while its listing and the headers
+// of its children are read, so the walk sees each listing whole.
+class TreeWalker {
+  HandlerBuilder handler_builder_;
+  std::shared_ptr<LockTable> inode_locks_;
+
+public:
+  using Visitor = std::function<void(Metadata const &)>;
+
+  TreeWalker() = default;
+  explicit TreeWalker(HandlerBuilder handler_builder, std::shared_ptr<LockTable> inode_locks = nullptr);
+
+  auto walk(std::uint64_t root_cluster, Visitor const &pre_order, Visitor const &post_order = {}) const -> void;
+
+private:
+  struct Frame;
+
+  [[nodiscard]] auto read_metadata(std::uint64_t cluster) const -> Metadata;
+  [[nodiscard]] auto read_children(Metadata const &dir_meta) const -> std::vector<Metadata>;
+};
+
+struct TreeWalker::Frame {
+  Metadata meta;
+  std::vector<Metadata> children;
+  std::size_t next_child;
+};
@@ -0,0 +1,40 @@
+#include "Writeback.hpp"
+
+Writeback::Writeback(std::shared_ptr<CombiningDisk> disk, Thresholds thresholds)
+    : disk_(std::move(disk)), thresholds_(thresholds), thread_(&Writeback::run, this) {}
+
+Writeback::~Writeback() {
+  try {
+    drain();
+  } catch (...) {} // NOLINT(bugprone-empty-catch) the disk flushes once more when it is destroyed
+}
+
+auto Writeback::drain() -> void {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  if (thread_.joinable()) thread_.join();
+  disk_->flush();
+}
+
+auto Writeback::get_flushes_count() const noexcept -> std::uint64_t { return flushes_count_; }
+
+auto Writeback::is_due() const -> bool {
+  return disk_->get_dirty_bytes() >= thresholds_.dirty_bytes || disk_->get_dirty_age() >= thresholds_.age;
+}
+
+auto Writeback::run() -> void {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!condition_.wait_for(lock, thresholds_.interval, [this]() { return stopping_; })) {
+    lock.unlock();
+    try {
+      if (is_due()) {
+        disk_->flush();
+        ++flushes_count_;
+      }
+    } catch (...) {} // NOLINT(bugprone-empty-catch) failed bytes stay pending, sync() reports the error
+    lock.lock();
+  }
+}
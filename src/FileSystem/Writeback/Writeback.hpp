@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../DiskHandler/Disk/CombiningDisk/CombiningDisk.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Background thread that writes the pending bytes of a combining disk back to the image, in offset order, once they
+// exceed the dirty-bytes threshold or the oldest of them is older than the age threshold. The thresholds sit below
+// the disk's own limits, so foreground writes rarely have to flush themselves.
+// Destroying the writeback stops the thread and drains whatever is still pending.
+class Writeback {
+public:
+  struct Thresholds {
+    std::uint64_t dirty_bytes;
+    std::chrono::milliseconds age;
+    std::chrono::milliseconds interval; // how often the thread looks at the disk
+  };
+
+private:
+  std::shared_ptr<CombiningDisk> disk_;
+  Thresholds thresholds_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool stopping_ = false;
+
+  std::atomic<std::uint64_t> flushes_count_ = 0;
+
+  std::thread thread_; // last, so it starts once everything it uses is constructed
+
+public:
+  Writeback(std::shared_ptr<CombiningDisk> disk, Thresholds thresholds);
+  Writeback(const Writeback &) = delete;
+  Writeback(Writeback &&) = delete;
+
+  ~Writeback();
+  auto operator=(const Writeback &) -> Writeback & = delete;
+  auto operator=(Writeback &&) -> Writeback & = delete;
+
+  auto drain() -> void;
+  [[nodiscard]] auto get_flushes_count() const noexcept -> std::uint64_t;
+
+private:
+  [[nodiscard]] auto is_due() const -> bool;
+  auto run() -> void;
+};
@@ -1,8 +1,43 @@
 #include "CLI/CLI.hpp"
 
-auto main() -> int {
+namespace {
+auto usage() -> int {
+  std::cerr << "Usage: cli [--image <path>] [--batch <script_path> | --batch -]\n";
+  return 1;
+}
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  std::vector<std::string> const args(argv + 1, argv + argc);
+
+  std::string image_path;
+  std::string script_path;
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    if (args[i] == "--image" && i + 1 < args.size()) {
+      image_path = args[++i];
+    } else if (args[i] == "--batch" && i + 1 < args.size()) {
+      script_path = args[++i];
+    } else {
+      return usage();
+    }
+  }
+
   try {
-    CLI cli;
-    cli.run();
-  } catch (std::exception const &e) { std::cerr << e.what() << '\n'; }
+    CLI cli(image_path);
+    if (script_path.empty()) {
+      cli.run();
+      return 0;
+    }
+
+    if (script_path == "-") return cli.run_batch(std::cin) ? 0 : 1;
+    std::ifstream script(script_path);
+    if (!script.is_open()) {
+      std::cerr << "Error while opening " << script_path << '\n';
+      return 1;
+    }
+    return cli.run_batch(script) ? 0 : 1;
+  } catch (std::exception const &e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
 }
@@ -0,0 +1,97 @@
+#include "../src/FileSystem/FileSystem.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <sstream>
+
+class AsyncTest : public testing::Test {
+protected:
+  // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+  std::string const PATH = "test.fs";
+  std::uint64_t const SIZE = 131072;
+  std::uint64_t const CLUSTER_SIZE = 128;
+
+  FileSystem file_system_;
+  // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+  auto SetUp() -> void override {
+    FileSystem::make(PATH, {SIZE, CLUSTER_SIZE});
+    file_system_ = FileSystem(PATH);
+  }
+
+  auto TearDown() -> void override { std::filesystem::remove(PATH); }
+};
+
+TEST_F(AsyncTest, AsyncRead) {
+  std::string const content(1000, 'a');
+  std::istringstream iss(content);
+  file_system_.import_file(iss, "file");
+
+  auto future = file_system_.async_read("file");
+  EXPECT_EQ(Converter::to_string(future.get()), content);
+}
+
+TEST_F(AsyncTest, AsyncWrite) {
+  file_system_.touch("file");
+  file_system_.async_write("file", Converter::to_bytes(std::string("Hello World!"))).get();
+  file_system_.async_write("file", Converter::to_bytes(std::string("There")), 6).get();
+
+  std::ostringstream oss;
+  file_system_.cat("file", oss);
+  EXPECT_EQ(oss.str(), "Hello There!");
+}
+
+TEST_F(AsyncTest, AsyncWritePastEnd) {
+  file_system_.touch("file");
+  auto future = file_system_.async_write("file", Converter::to_bytes(std::string("data")), 1);
+  EXPECT_THROW(future.get(), std::invalid_argument);
+}
+
+TEST_F(AsyncTest, AsyncImport) {
+  std::string const content(500, 'b');
+  file_system_.async_import(std::make_shared<std::istringstream>(content), "file").get();
+
+  EXPECT_EQ(Converter::to_string(file_system_.read_file("file")), content);
+}
+
+TEST_F(AsyncTest, AsyncCopyDirectory) {
+  file_system_.mkdir("dir");
+  std::istringstream iss(std::string(700, 'c'));
+  file_system_.import_file(iss, "dir/file");
+
+  file_system_.async_cp("dir", "copy", true).get();
+
+  EXPECT_EQ(file_system_.read_file("copy/file"), file_system_.read_file("dir/file"));
+}
+
+TEST_F(AsyncTest, AsyncReadMissingFile) {
+  auto future = file_system_.async_read("missing");
+  EXPECT_THROW(future.get(), std::invalid_argument);
+}
+
+TEST_F(AsyncTest, ManyOperationsInFlight) {
+  int const FILES_COUNT = 16;
+
+  std::vector<std::future<void>> imports;
+  for (int i = 0; i < FILES_COUNT; ++i) {
+    auto content = std::string(static_cast<std::size_t>(100 + i), static_cast<char>('a' + i));
+    imports.push_back(file_system_.async_import(std::make_shared<std::istringstream>(content), std::to_string(i)));
+  }
+  for (auto &future : imports) future.get();
+
+  std::vector<std::future<std::vector<std::byte>>> reads;
+  for (int i = 0; i < FILES_COUNT; ++i) reads.push_back(file_system_.async_read(std::to_string(i)));
+  for (int i = 0; i < FILES_COUNT; ++i) {
+    EXPECT_EQ(Converter::to_string(reads[i].get()),
+              std::string(static_cast<std::size_t>(100 + i), static_cast<char>('a' + i)));
+  }
+}
+
+TEST_F(AsyncTest, ResolvesAgainstSubmittingDirectory) {
+  file_system_.mkdir("dir");
+  file_system_.cd("dir");
+  auto future = file_system_.async_import(std::make_shared<std::istringstream>("content"), "file");
+  file_system_.cd("/");
+  future.get();
+
+  EXPECT_EQ(Converter::to_string(file_system_.read_file("dir/file")), "content");
+}
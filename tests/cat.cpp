@@ -79,4 +79,49 @@ TEST_F(CatTest, CatFileWithMultipleLines) {
   file_system_.cat("file1", oss);
   auto content = oss.str();
   EXPECT_EQ(content, "1 Hello World!\n2 Hello World!\n3 Hello World!\n");
-}
\ No newline at end of file
+}
+
+TEST_F(CatTest, CatBinaryFile) {
+  std::vector<std::byte> bytes;
+  for (int i = 0; i < 300; ++i) bytes.push_back(static_cast<std::byte>(i % 7 == 0 ? 0 : i % 256));
+  file_system_.touch("file1");
+  file_system_.write_file("file1", bytes);
+
+  std::ostringstream oss;
+  file_system_.cat("file1", oss);
+  auto content = oss.str();
+  ASSERT_EQ(content.size(), bytes.size());
+  EXPECT_TRUE(std::equal(content.begin(), content.end(), bytes.begin(),
+                         [](char c, std::byte b) { return static_cast<std::byte>(c) == b; }));
+}
+
+TEST_F(CatTest, CatRange) {
+  // interleaved appends spread both files over several runs of clusters
+  std::string content;
+  file_system_.touch("file1");
+  file_system_.touch("file2");
+  for (char c = 'a'; c < 'h'; ++c) {
+    content += std::string(static_cast<std::size_t>(CLUSTER_SIZE) / 2, c);
+    file_system_.write_file("file1", Converter::to_bytes(content));
+    file_system_.write_file("file2", Converter::to_bytes(content));
+  }
+
+  auto cat = [this](std::uint64_t offset, std::uint64_t length) {
+    std::ostringstream oss;
+    file_system_.cat("file1", oss, offset, length);
+    return oss.str();
+  };
+  EXPECT_EQ(cat(0, 5), content.substr(0, 5));
+  EXPECT_EQ(cat(30, 40), content.substr(30, 40));
+  EXPECT_EQ(cat(100, 1000), content.substr(100));
+  EXPECT_EQ(cat(content.size(), 10), "");
+  EXPECT_EQ(cat(content.size() + 10, 10), "");
+
+  std::ostringstream oss;
+  file_system_.tail("file1", oss, 50);
+  EXPECT_EQ(oss.str(), content.substr(content.size() - 50));
+  oss.str("");
+  file_system_.tail("file1", oss, 1000);
+  EXPECT_EQ(oss.str(), content);
+  EXPECT_THROW(file_system_.tail("missing", oss, 1), std::invalid_argument);
+}
@@ -0,0 +1,104 @@
+#include "../src/CLI/CLI.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <sstream>
+
+class CLITest : public testing::Test {
+protected:
+  // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+  std::string const PATH = "test.fs";
+  std::uint64_t const SIZE = 256 * 1024;
+  std::uint64_t const CLUSTER_SIZE = 256;
+  // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+  auto SetUp() -> void override { FileSystem::make(PATH, {SIZE, CLUSTER_SIZE}); }
+
+  auto TearDown() -> void override { std::filesystem::remove(PATH); }
+};
+
+TEST_F(CLITest, BatchRunsOnExistingImage) {
+  std::istringstream script("# provisioning\n"
+                            "mkdir /dir\n"
+                            "\n"
+                            "touch /dir/file\n"
+                            "exit\n"
+                            "touch /dir/ignored\n");
+  {
+    CLI cli(PATH);
+    EXPECT_TRUE(cli.run_batch(script));
+  }
+
+  ASSERT_TRUE(std::filesystem::exists(PATH));
+  FileSystem file_system(PATH);
+  EXPECT_NO_THROW(static_cast<void>(file_system.stat("/dir/file")));
+  EXPECT_THROW(static_cast<void>(file_system.stat("/dir/ignored")), std::invalid_argument);
+}
+
+TEST_F(CLITest, BatchReportsFailures) {
+  std::istringstream script("rmdir /missing\n"
+                            "frobnicate\n"
+                            "mkdir /dir\n");
+  {
+    CLI cli(PATH);
+    EXPECT_FALSE(cli.run_batch(script));
+  }
+
+  FileSystem file_system(PATH);
+  EXPECT_NO_THROW(static_cast<void>(file_system.stat("/dir")));
+}
+
+TEST_F(CLITest, BatchReportsUsageErrors) {
+  {
+    FileSystem file_system(PATH);
+    file_system.touch("/file");
+    file_system.drain();
+  }
+
+  for (auto const *line : {"mkdir\n", "ls -x /dir /other\n", "record stop\n", "import /missing.tar\n",
+                           "head -c -1 /file\n", "cat --length 1x /file\n", "cp -r -j 0 /file /copy\n",
+                           "export -j -1 /file exported\n"}) {
+    std::istringstream script(line);
+    CLI cli(PATH);
+    EXPECT_FALSE(cli.run_batch(script)) << line;
+  }
+}
+
+TEST_F(CLITest, ReplayLeavesWorkingDirectoryAlone) {
+  {
+    std::ofstream trace("trace.txt");
+    trace << "0 0 mkdir /dir\n";
+    std::ofstream unrelated("replay.fs");
+    unrelated << "unrelated";
+  }
+
+  {
+    CLI cli(PATH);
+    std::istringstream failing("replay trace.txt -j 0\n");
+    EXPECT_FALSE(cli.run_batch(failing));
+    std::istringstream script("replay trace.txt -j 2\n");
+    EXPECT_TRUE(cli.run_batch(script));
+  }
+
+  std::ifstream unrelated("replay.fs");
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(unrelated), {}), "unrelated");
+  std::filesystem::remove("trace.txt");
+  std::filesystem::remove("replay.fs");
+}
+
+TEST_F(CLITest, FailedExportKeepsHostEntry) {
+  {
+    FileSystem file_system(PATH);
+    file_system.touch("/file");
+    file_system.drain();
+  }
+  std::filesystem::create_directory("export_target");
+
+  {
+    CLI cli(PATH);
+    std::istringstream script("export /file export_target\n");
+    EXPECT_FALSE(cli.run_batch(script));
+  }
+
+  EXPECT_TRUE(std::filesystem::is_directory("export_target"));
+  std::filesystem::remove("export_target");
+}
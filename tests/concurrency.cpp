@@ -0,0 +1,175 @@
+#include "../src/FileSystem/FileSystem.hpp"
+#include <atomic>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+
+class ConcurrencyTest : public testing::Test {
+protected:
+  // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+  std::string const PATH = "test.fs";
+  std::uint64_t const SIZE = 262144;
+  std::uint64_t const CLUSTER_SIZE = 128;
+  int const THREADS = 4;
+  int const ITERATIONS = 50;
+
+  FileSystem file_system_;
+  // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+  auto SetUp() -> void override {
+    FileSystem::make(PATH, {SIZE, CLUSTER_SIZE});
+    file_system_ = FileSystem(PATH);
+  }
+
+  auto TearDown() -> void override { std::filesystem::remove(PATH); }
+};
+
+TEST_F(ConcurrencyTest, ParallelTouchInSameDirectory) {
+  file_system_.mkdir("dir");
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([this, t]() {
+      for (int i = 0; i < ITERATIONS; ++i) file_system_.touch("dir/file" + std::to_string(t * ITERATIONS + i));
+    });
+  }
+  for (auto &thread : threads) thread.join();
+
+  EXPECT_EQ(file_system_.ls("dir").size(), THREADS * ITERATIONS);
+}
+
+TEST_F(ConcurrencyTest, ParallelImportOfSameFile) {
+  std::atomic<int> imported{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([this, &imported]() {
+      std::istringstream iss("content");
+      try {
+        file_system_.import_file(iss, "file");
+        ++imported;
+      } catch (std::invalid_argument const &) {}
+    });
+  }
+  for (auto &thread : threads) thread.join();
+
+  EXPECT_EQ(imported, 1);
+  EXPECT_EQ(file_system_.ls("/").size(), 1);
+}
+
+TEST_F(ConcurrencyTest, ParallelCatLsTouchRm) {
+  std::string const content(1000, 'x');
+  std::istringstream iss(content);
+  file_system_.import_file(iss, "shared");
+  file_system_.mkdir("dir");
+
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([this, &content, &failed]() {
+      for (int i = 0; i < ITERATIONS; ++i) {
+        std::ostringstream oss;
+        file_system_.cat("shared", oss);
+        if (oss.str() != content) failed = true;
+        static_cast<void>(file_system_.ls("dir"));
+      }
+    });
+  }
+
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([this, t]() {
+      for (int i = 0; i < ITERATIONS; ++i) {
+        auto path = "dir/file" + std::to_string(t) + "_" + std::to_string(i);
+        file_system_.touch(path);
+        file_system_.rm(path);
+      }
+    });
+  }
+
+  for (auto &thread : threads) thread.join();
+
+  EXPECT_FALSE(failed);
+  EXPECT_TRUE(file_system_.ls("dir").empty());
+
+  std::ostringstream oss;
+  file_system_.cat("shared", oss);
+  EXPECT_EQ(oss.str(), content);
+}
+
+TEST_F(ConcurrencyTest, LookupsWhileCreatingInSameDirectory) {
+  file_system_.mkdir("dir");
+  file_system_.touch("dir/fixed");
+
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([this, t, &failed]() {
+      for (int i = 0; i < ITERATIONS; ++i) {
+        if (t % 2 == 0) {
+          file_system_.touch("dir/file" + std::to_string(t) + "_" + std::to_string(i));
+        } else if (file_system_.stat("dir/fixed").get_name() != "fixed") {
+          failed = true;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+
+  EXPECT_FALSE(failed);
+  EXPECT_EQ(file_system_.ls("dir").size(), (THREADS / 2) * ITERATIONS + 1);
+}
+
+TEST_F(ConcurrencyTest, DuWhileCreatingInTree) {
+  file_system_.mkdir("dir");
+  file_system_.mkdir("dir/nested");
+
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([this, t, &failed]() {
+      for (int i = 0; i < ITERATIONS; ++i) {
+        if (t % 2 == 0) {
+          file_system_.touch("dir/nested/file" + std::to_string(t) + "_" + std::to_string(i));
+        } else if (file_system_.du("dir").dirs_count != 2) {
+          failed = true;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+
+  EXPECT_FALSE(failed);
+  EXPECT_EQ(file_system_.du("dir").files_count, (THREADS / 2) * ITERATIONS);
+}
+
+TEST_F(ConcurrencyTest, ParallelImportFromHost) {
+  std::string content;
+  for (int i = 0; i < 1000; ++i) content += static_cast<char>('a' + i % 26);
+  {
+    std::ofstream file("host.bin", std::ios::binary);
+    file << content;
+  }
+
+  int const files_count = 10;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([this, t]() {
+      for (int i = 0; i < files_count; ++i) {
+        file_system_.import_from_host("host.bin", "file" + std::to_string(t) + "_" + std::to_string(i));
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  std::filesystem::remove("host.bin");
+
+  EXPECT_EQ(file_system_.ls("/").size(), THREADS * files_count);
+  for (int t = 0; t < THREADS; ++t) {
+    for (int i = 0; i < files_count; ++i) {
+      std::ostringstream oss;
+      file_system_.cat("file" + std::to_string(t) + "_" + std::to_string(i), oss);
+      EXPECT_EQ(oss.str(), content);
+    }
+  }
+}
@@ -153,3 +153,130 @@ TEST_F(CpTest, CopyEmptyDirectoryRecursively) {
   EXPECT_EQ(list[1].get_name(), "original_dir");
   EXPECT_EQ(list[2].get_name(), "copy_dir");
 }
+
+TEST_F(CpTest, ReflinkCopyFile) {
+  file_system_.cp("samples/long.txt", "long_clone.txt", false, true);
+
+  std::ostringstream original;
+  file_system_.cat("samples/long.txt", original);
+
+  std::ostringstream clone;
+  file_system_.cat("long_clone.txt", clone);
+
+  EXPECT_EQ(original.str(), clone.str());
+  EXPECT_EQ(file_system_.stat("long_clone.txt").get_size(), file_system_.stat("samples/long.txt").get_size());
+}
+
+TEST_F(CpTest, ReflinkCopyIsCopyOnWrite) {
+  std::ostringstream original;
+  file_system_.cat("samples/long.txt", original);
+
+  file_system_.cp("samples/long.txt", "long_clone.txt", false, true);
+  auto writer = file_system_.get_writer("long_clone.txt");
+  writer.set_offset(CLUSTER_SIZE * 4);
+  writer.write(Converter::to_bytes(std::string("overwritten")));
+
+  std::ostringstream source_after_write;
+  file_system_.cat("samples/long.txt", source_after_write);
+  EXPECT_EQ(original.str(), source_after_write.str());
+
+  std::ostringstream clone;
+  file_system_.cat("long_clone.txt", clone);
+  auto expected = original.str();
+  expected.replace(CLUSTER_SIZE * 4, std::string("overwritten").size(), "overwritten");
+  EXPECT_EQ(clone.str(), expected);
+}
+
+TEST_F(CpTest, ReflinkCopySurvivesSourceRemoval) {
+  std::ostringstream original;
+  file_system_.cat("samples/long.txt", original);
+
+  file_system_.cp("samples", "samples_clone", true, true);
+  file_system_.rm("samples", true);
+
+  std::ostringstream clone;
+  file_system_.cat("samples_clone/long.txt", clone);
+  EXPECT_EQ(original.str(), clone.str());
+}
+
+TEST_F(CpTest, CopyDirectoryIntoItself) {
+  EXPECT_THROW(file_system_.cp("samples", "samples/copy", true), std::invalid_argument);
+  EXPECT_THROW(file_system_.cp("/", "/copy", true), std::invalid_argument);
+}
+
+TEST_F(CpTest, CopyDeepTree) {
+  file_system_.mkdir("a");
+  file_system_.mkdir("a/b");
+  file_system_.mkdir("a/b/c");
+  file_system_.mkdir("a/empty");
+  file_system_.cp("samples/short.txt", "a/b/c/short.txt");
+  file_system_.cp("samples/long.txt", "a/b/long.txt");
+
+  file_system_.cp("a", "copy", true);
+
+  auto copy_list = file_system_.ls("copy");
+  ASSERT_EQ(copy_list.size(), 2);
+  EXPECT_EQ(copy_list[0].get_name(), "b");
+  EXPECT_EQ(copy_list[1].get_name(), "empty");
+  EXPECT_EQ(file_system_.stat("copy/b").get_parent_first_cluster(), file_system_.stat("copy").get_first_cluster());
+
+  auto nested_list = file_system_.ls("copy/b");
+  ASSERT_EQ(nested_list.size(), 2);
+  EXPECT_EQ(nested_list[0].get_name(), "c");
+  EXPECT_EQ(nested_list[1].get_name(), "long.txt");
+
+  std::ostringstream original;
+  std::ostringstream copy;
+  file_system_.cat("a/b/c/short.txt", original);
+  file_system_.cat("copy/b/c/short.txt", copy);
+  EXPECT_EQ(original.str(), copy.str());
+  EXPECT_EQ(file_system_.pwd(), "/");
+}
+
+TEST_F(CpTest, CopyDirectoryInParallel) {
+  file_system_.mkdir("tree");
+  file_system_.mkdir("tree/nested");
+  file_system_.cp("samples/long.txt", "tree/long.txt");
+  for (int i = 0; i < 8; ++i) {
+    file_system_.cp("samples/short.txt", "tree/short" + std::to_string(i) + ".txt");
+    file_system_.cp("samples/short.txt", "tree/nested/short" + std::to_string(i) + ".txt");
+  }
+
+  file_system_.cp("tree", "copy", true, false, 4);
+
+  ASSERT_EQ(file_system_.ls("copy").size(), 10);
+  ASSERT_EQ(file_system_.ls("copy/nested").size(), 8);
+
+  std::vector<std::string> files = {"long.txt"};
+  for (int i = 0; i < 8; ++i) {
+    files.push_back("short" + std::to_string(i) + ".txt");
+    files.push_back("nested/short" + std::to_string(i) + ".txt");
+  }
+  for (auto const &file : files) {
+    std::ostringstream original;
+    std::ostringstream copy;
+    file_system_.cat("tree/" + file, original);
+    file_system_.cat("copy/" + file, copy);
+    EXPECT_EQ(original.str(), copy.str());
+  }
+}
+
+TEST_F(CpTest, FailedCopyReleasesClusters) {
+  // copies are made until the image is full, the one that does not fit must not keep any of its clusters
+  for (int i = 0;; ++i) {
+    ASSERT_LT(i, 1000);
+    auto const allocated = file_system_.get_allocated_clusters_count();
+    auto const copy = "copy" + std::to_string(i);
+    try {
+      file_system_.cp("samples", copy, true);
+    } catch (std::exception const &) {
+      EXPECT_THROW(static_cast<void>(file_system_.stat(copy)), std::invalid_argument);
+      EXPECT_EQ(file_system_.get_allocated_clusters_count(), allocated);
+
+      std::size_t const threads = 4;
+      EXPECT_ANY_THROW(file_system_.cp("samples", copy, true, false, threads));
+      EXPECT_EQ(file_system_.get_allocated_clusters_count(), allocated);
+      break;
+    }
+  }
+}
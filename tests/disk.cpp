@@ -0,0 +1,287 @@
+#include "../src/FileSystem/FileSystem.hpp"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <thread>
+
+class DiskTest : public testing::Test {
+protected:
+  // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+  std::string const PATH = "test.fs";
+  std::uint64_t const SIZE = 4096;
+  // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+  auto SetUp() -> void override {
+    std::ofstream ofs(PATH, std::ios::binary);
+    for (std::uint64_t i = 0; i < SIZE; ++i) ofs.put(static_cast<char>(i % 256));
+  }
+
+  auto TearDown() -> void override { std::filesystem::remove(PATH); }
+
+  static auto check_batches(Disk &disk) -> void {
+    std::vector<Disk::WriteRequest> writes;
+    for (std::uint64_t i = 0; i < 100; ++i) writes.push_back({i * 16, std::vector<std::byte>(8, std::byte{0xAB})});
+    disk.write_batch(writes);
+
+    std::vector<Disk::ReadRequest> reads;
+    for (std::uint64_t i = 0; i < 100; ++i) reads.push_back({i * 16, 16});
+    reads.push_back({4090, 16}); // crosses the end of the image
+    reads.push_back({8192, 16}); // past the end
+
+    auto blocks = disk.read_batch(reads);
+    ASSERT_EQ(blocks.size(), reads.size());
+    for (std::uint64_t i = 0; i < 100; ++i) {
+      ASSERT_EQ(blocks[i].size(), 16);
+      EXPECT_EQ(blocks[i][0], std::byte{0xAB});
+      EXPECT_EQ(blocks[i][7], std::byte{0xAB});
+      EXPECT_EQ(blocks[i][8], static_cast<std::byte>((i * 16 + 8) % 256));
+    }
+    EXPECT_EQ(blocks[100].size(), 6);
+    EXPECT_TRUE(blocks[101].empty());
+
+    // back to back requests, merged into vectored calls
+    std::vector<Disk::WriteRequest> adjacent_writes;
+    for (std::uint64_t i = 0; i < 10; ++i) {
+      adjacent_writes.push_back({2048 + i * 8, std::vector<std::byte>(8, static_cast<std::byte>(i))});
+    }
+    disk.write_batch(adjacent_writes);
+
+    auto adjacent_blocks = disk.read_batch({{2048, 40}, {2088, 40}, {3000, 4}});
+    ASSERT_EQ(adjacent_blocks.size(), 3);
+    EXPECT_EQ(adjacent_blocks[0][0], std::byte{0});
+    EXPECT_EQ(adjacent_blocks[0][39], std::byte{4});
+    EXPECT_EQ(adjacent_blocks[1][0], std::byte{5});
+    EXPECT_EQ(adjacent_blocks[1][39], std::byte{9});
+    EXPECT_EQ(adjacent_blocks[2][0], static_cast<std::byte>(3000 % 256));
+
+    // out of order and overlapping, the later write to a byte wins
+    disk.write_batch({{3508, std::vector<std::byte>(8, std::byte{1})},
+                      {3500, std::vector<std::byte>(12, std::byte{2})},
+                      {3504, std::vector<std::byte>(2, std::byte{3})}});
+    auto overlapped = disk.read_at(3500, 16);
+    EXPECT_EQ(overlapped[0], std::byte{2});
+    EXPECT_EQ(overlapped[4], std::byte{3});
+    EXPECT_EQ(overlapped[6], std::byte{2});
+    EXPECT_EQ(overlapped[11], std::byte{2});
+    EXPECT_EQ(overlapped[15], std::byte{1});
+  }
+};
+
+#ifndef _WIN32
+TEST_F(DiskTest, FileDiskBatches) {
+  FileDisk disk(PATH);
+  check_batches(disk);
+}
+#endif
+
+#ifdef FS_HAVE_IO_URING
+TEST_F(DiskTest, UringDiskBatches) {
+  std::unique_ptr<UringDisk> disk;
+  try {
+    disk = std::make_unique<UringDisk>(PATH);
+  } catch (std::system_error const &) { GTEST_SKIP() << "io_uring is not available"; }
+  check_batches(*disk);
+}
+
+TEST_F(DiskTest, UringDiskBatchesFromSeveralThreads) {
+  std::unique_ptr<UringDisk> disk;
+  try {
+    disk = std::make_unique<UringDisk>(PATH);
+  } catch (std::system_error const &) { GTEST_SKIP() << "io_uring is not available"; }
+
+  // every thread owns every fourth 16-byte slot, batches of all threads are in flight at once
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> threads;
+  for (std::uint64_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&disk, &failed, t]() {
+      for (int round = 0; round < 50; ++round) {
+        auto value = static_cast<std::byte>(t * 50 + round);
+        std::vector<Disk::WriteRequest> writes;
+        std::vector<Disk::ReadRequest> reads;
+        for (std::uint64_t slot = t; slot < 256; slot += 4) {
+          writes.push_back({slot * 16, std::vector<std::byte>(16, value)});
+          reads.push_back({slot * 16, 16});
+        }
+        disk->write_batch(writes);
+        for (auto const &block : disk->read_batch(reads)) {
+          if (block != std::vector<std::byte>(16, value)) failed = true;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+
+  EXPECT_FALSE(failed);
+}
+#endif
+
+// keeps the image in memory and counts the writes that reach it
+class MemoryDisk : public Disk {
+public:
+  // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+  std::vector<std::byte> bytes;
+  std::size_t writes_count = 0;
+  std::vector<std::uint64_t> write_offsets;
+  // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+  explicit MemoryDisk(std::size_t size) : bytes(size) {}
+
+  auto read_at(std::uint64_t offset, std::uint64_t size) -> std::vector<std::byte> override {
+    auto end = std::min<std::uint64_t>(bytes.size(), offset + size);
+    if (offset >= end) return {};
+    return {bytes.begin() + static_cast<std::int64_t>(offset), bytes.begin() + static_cast<std::int64_t>(end)};
+  }
+
+  auto write_at(std::uint64_t offset, std::vector<std::byte> const &data) -> void override {
+    ++writes_count;
+    write_offsets.push_back(offset);
+    std::copy(data.begin(), data.end(), bytes.begin() + static_cast<std::int64_t>(offset));
+  }
+};
+
+TEST(DiskScheduleTest, WritesGoOutInOffsetOrder) {
+  MemoryDisk disk(1024);
+  disk.write_batch({{600, std::vector<std::byte>(8, std::byte{1})},
+                    {100, std::vector<std::byte>(8, std::byte{2})},
+                    {300, std::vector<std::byte>(8, std::byte{3})},
+                    {96, std::vector<std::byte>(8, std::byte{4})}});
+
+  EXPECT_EQ(disk.write_offsets, (std::vector<std::uint64_t>{96, 300, 600}));
+  EXPECT_EQ(disk.bytes[96], std::byte{4});
+  EXPECT_EQ(disk.bytes[103], std::byte{4});
+  EXPECT_EQ(disk.bytes[104], std::byte{2});
+}
+
+TEST(CombiningDiskTest, MergesWritesToSamePage) {
+  auto memory = std::make_shared<MemoryDisk>(1024);
+  CombiningDisk disk(memory, 64, 16, {4096, std::chrono::hours(1)});
+
+  disk.write_at(16, std::vector<std::byte>(8, std::byte{1}));  // page [16, 80)
+  disk.write_at(24, std::vector<std::byte>(8, std::byte{2}));  // adjacent
+  disk.write_at(20, std::vector<std::byte>(8, std::byte{3}));  // overlapping
+  disk.write_at(70, std::vector<std::byte>(20, std::byte{4})); // runs into the next page
+  EXPECT_EQ(memory->writes_count, 0);
+  EXPECT_EQ(disk.get_dirty_bytes(), 16 + 20);
+
+  auto block = disk.read_at(16, 16);
+  EXPECT_EQ(block[0], std::byte{1});
+  EXPECT_EQ(block[4], std::byte{3});
+  EXPECT_EQ(block[15], std::byte{2});
+
+  disk.flush();
+  EXPECT_EQ(memory->writes_count, 2);
+  EXPECT_EQ(disk.get_dirty_bytes(), 0);
+  EXPECT_EQ(memory->bytes[20], std::byte{3});
+  EXPECT_EQ(memory->bytes[89], std::byte{4});
+}
+
+TEST(CombiningDiskTest, FlushesAtDirtyLimit) {
+  auto memory = std::make_shared<MemoryDisk>(1024);
+  CombiningDisk disk(memory, 64, 0, {100, std::chrono::hours(1)});
+
+  disk.write_at(0, std::vector<std::byte>(60, std::byte{1}));
+  EXPECT_EQ(memory->writes_count, 0);
+  disk.write_at(200, std::vector<std::byte>(60, std::byte{2}));
+  EXPECT_EQ(disk.get_dirty_bytes(), 0);
+  EXPECT_EQ(memory->writes_count, 2);
+
+  disk.write_at(500, std::vector<std::byte>(100, std::byte{3})); // bypasses the buffer
+  EXPECT_EQ(memory->writes_count, 3);
+}
+
+TEST(CombiningDiskTest, FlushesOnDestruction) {
+  auto memory = std::make_shared<MemoryDisk>(1024);
+  {
+    CombiningDisk disk(memory, 64, 0, {4096, std::chrono::hours(1)});
+    disk.write_at(10, std::vector<std::byte>(4, std::byte{7}));
+  }
+  EXPECT_EQ(memory->bytes[10], std::byte{7});
+}
+
+TEST(CombiningDiskTest, SyncMakesWritesVisibleToOtherInstances) {
+  std::string const path = "test.fs";
+  FileSystem::make(path, {8192, 128});
+  FileSystem file_system(path);
+  file_system.touch("file");
+  file_system.write_file("file", Converter::to_bytes(std::string("combined")));
+  file_system.sync();
+
+  FileSystem other(path);
+  EXPECT_EQ(Converter::to_string(other.read_file("file")), "combined");
+  std::filesystem::remove(path);
+}
+
+TEST(WritebackTest, FlushesAgedWritesInBackground) {
+  auto memory = std::make_shared<MemoryDisk>(1024);
+  auto disk = std::make_shared<CombiningDisk>(memory, 64, 0, CombiningDisk::Limits{4096, std::chrono::hours(1)});
+  Writeback writeback(disk, {4096, std::chrono::milliseconds(5), std::chrono::milliseconds(1)});
+
+  disk->write_at(10, std::vector<std::byte>(4, std::byte{7}));
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (disk->get_dirty_bytes() > 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  writeback.drain(); // joins the thread before the image is looked at
+  EXPECT_EQ(disk->get_dirty_bytes(), 0);
+  EXPECT_GE(writeback.get_flushes_count(), 1);
+  EXPECT_EQ(memory->bytes[10], std::byte{7});
+}
+
+TEST(WritebackTest, FlushesAtDirtyThreshold) {
+  auto memory = std::make_shared<MemoryDisk>(1024);
+  auto disk = std::make_shared<CombiningDisk>(memory, 64, 0, CombiningDisk::Limits{4096, std::chrono::hours(1)});
+  Writeback writeback(disk, {100, std::chrono::hours(1), std::chrono::milliseconds(1)});
+
+  disk->write_at(0, std::vector<std::byte>(50, std::byte{1}));
+  disk->write_at(200, std::vector<std::byte>(60, std::byte{2}));
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (writeback.get_flushes_count() == 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  writeback.drain();
+  EXPECT_EQ(writeback.get_flushes_count(), 1);
+  EXPECT_EQ(memory->bytes[0], std::byte{1});
+  EXPECT_EQ(memory->bytes[259], std::byte{2});
+}
+
+TEST(WritebackTest, DrainFlushesPendingWrites) {
+  auto memory = std::make_shared<MemoryDisk>(1024);
+  auto disk = std::make_shared<CombiningDisk>(memory, 64, 0, CombiningDisk::Limits{4096, std::chrono::hours(1)});
+  Writeback writeback(disk, {4096, std::chrono::hours(1), std::chrono::milliseconds(1)});
+
+  disk->write_at(300, std::vector<std::byte>(4, std::byte{9}));
+  writeback.drain();
+  EXPECT_EQ(writeback.get_flushes_count(), 0);
+  EXPECT_EQ(disk->get_dirty_bytes(), 0);
+  EXPECT_EQ(memory->bytes[300], std::byte{9});
+
+  // the disk keeps working once the thread is gone
+  disk->write_at(400, std::vector<std::byte>(4, std::byte{5}));
+  writeback.drain();
+  EXPECT_EQ(memory->bytes[400], std::byte{5});
+}
+
+TEST(WritebackTest, FileSystemWritesReachImageWithoutSync) {
+  std::string const path = "test.fs";
+  FileSystem::make(path, {8192, 128});
+  FileSystem file_system(path);
+  file_system.touch("file");
+  file_system.write_file("file", Converter::to_bytes(std::string("written back")));
+
+  auto image_contains = [&path](std::string const &text) {
+    std::ifstream ifs(path, std::ios::binary);
+    std::string image((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    return image.find(text) != std::string::npos;
+  };
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!image_contains("written back") && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_TRUE(image_contains("written back"));
+
+  file_system.drain();
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,120 @@
+#include "../src/FileSystem/FileSystem.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+
+class DuTest : public testing::Test {
+protected:
+  // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+  std::string const PATH = "test.fs";
+  std::uint64_t const SIZE = 65536;
+  std::uint64_t const CLUSTER_SIZE = 64;
+
+  FileSystem file_system_;
+  // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+  auto SetUp() -> void override {
+    FileSystem::make(PATH, {SIZE, CLUSTER_SIZE});
+    file_system_ = FileSystem(PATH);
+  }
+
+  auto TearDown() -> void override { std::filesystem::remove(PATH); }
+
+  auto write(std::string const &path, std::string const &content) -> void {
+    file_system_.touch(path);
+    std::vector<std::byte> bytes(content.size());
+    std::transform(content.begin(), content.end(), bytes.begin(), [](char c) { return std::byte(c); });
+    file_system_.write_file(path, bytes);
+  }
+};
+
+TEST_F(DuTest, NonExistent) {
+  EXPECT_THROW(static_cast<void>(file_system_.du("/non_existent")), std::invalid_argument);
+}
+
+TEST_F(DuTest, File) {
+  write("/file", std::string(100, 'a'));
+
+  auto const usage = file_system_.du("/file");
+  EXPECT_EQ(usage.files_count, 1);
+  EXPECT_EQ(usage.dirs_count, 0);
+  EXPECT_EQ(usage.size, 100);
+  EXPECT_EQ(usage.clusters_count, 3); // 89 bytes of header and 100 of data
+}
+
+TEST_F(DuTest, Tree) {
+  file_system_.mkdir("/dir");
+  file_system_.mkdir("/dir/nested");
+  write("/dir/first", "first");
+  write("/dir/nested/second", std::string(200, 'b'));
+  file_system_.touch("/dir/nested/empty");
+  write("/outside", "outside");
+
+  auto const usage = file_system_.du("/dir");
+  EXPECT_EQ(usage.files_count, 3);
+  EXPECT_EQ(usage.dirs_count, 2);
+  EXPECT_EQ(usage.size, 205);
+
+  std::uint64_t clusters_count = 0;
+  for (auto const *path : {"/dir", "/dir/nested", "/dir/first", "/dir/nested/second", "/dir/nested/empty"}) {
+    auto const size = Metadata::get_metadata_size() + file_system_.stat(path).get_size();
+    clusters_count += (size + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+  }
+  EXPECT_EQ(usage.clusters_count, clusters_count);
+}
+
+TEST_F(DuTest, ListingOrderKeptWhenReadInDiskOrder) {
+  // freed clusters are reused, so later entries of the listing end up in front of earlier ones on disk
+  for (int i = 0; i < 8; ++i) file_system_.touch("/old" + std::to_string(i));
+  for (int i = 0; i < 8; i += 2) file_system_.rm("/old" + std::to_string(i));
+  for (int i = 0; i < 4; ++i) file_system_.touch("/new" + std::to_string(i));
+
+  std::vector<std::string> names;
+  for (auto const &meta : file_system_.ls("/")) names.push_back(meta.get_name());
+
+  std::vector<std::string> expected;
+  for (auto const *name : {"old1", "old3", "old5", "old7", "new0", "new1", "new2", "new3"}) expected.emplace_back(name);
+  std::sort(names.begin(), names.end());
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(names, expected);
+
+  for (auto const &meta : file_system_.ls("/")) {
+    EXPECT_EQ(file_system_.stat("/" + meta.get_name()).get_first_cluster(), meta.get_first_cluster());
+  }
+  EXPECT_EQ(file_system_.du("/").files_count, 8);
+}
+
+class DuLargeClustersTest : public testing::Test {
+protected:
+  // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+  std::string const PATH = "test.fs";
+  std::uint64_t const SIZE = 1048576;
+  std::uint64_t const CLUSTER_SIZE = 4096;
+
+  FileSystem file_system_;
+  // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+  auto SetUp() -> void override {
+    FileSystem::make(PATH, {SIZE, CLUSTER_SIZE});
+    file_system_ = FileSystem(PATH);
+  }
+
+  auto TearDown() -> void override { std::filesystem::remove(PATH); }
+};
+
+TEST_F(DuLargeClustersTest, ManyEntries) {
+  file_system_.mkdir("/dir");
+  for (int i = 0; i < 100; ++i) file_system_.touch("/dir/file" + std::to_string(i));
+  for (int i = 0; i < 100; i += 3) file_system_.rm("/dir/file" + std::to_string(i));
+  for (int i = 0; i < 20; ++i) file_system_.mkdir("/dir/sub" + std::to_string(i));
+
+  for (auto const &meta : file_system_.ls("/dir")) {
+    EXPECT_EQ(file_system_.stat("/dir/" + meta.get_name()).get_first_cluster(), meta.get_first_cluster());
+    EXPECT_EQ(meta.get_parent_first_cluster(), file_system_.stat("/dir").get_first_cluster());
+  }
+
+  auto const usage = file_system_.du("/dir");
+  EXPECT_EQ(usage.files_count, 66);
+  EXPECT_EQ(usage.dirs_count, 21);
+  EXPECT_EQ(usage.size, 0);
+  EXPECT_EQ(usage.clusters_count, 66 + 20 + 1);
+}
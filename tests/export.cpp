@@ -86,3 +86,65 @@ TEST_F(ExportTest, ExportDirectory) {
   EXPECT_THROW(file_system_.export_file("samples", export_stream), std::invalid_argument);
   export_stream.close();
 }
+
+TEST_F(ExportTest, ExportDirectoryTree) {
+  file_system_.mkdir("samples/nested");
+  file_system_.mkdir("samples/nested/empty");
+  file_system_.touch("samples/nested/empty.txt");
+
+  std::filesystem::path const host_dir = "exported_tree";
+  std::size_t const threads = 2;
+  file_system_.export_dir("samples", host_dir.string(), threads);
+
+  for (auto const *path : {"short.txt", "long.txt", "nested/empty.txt"}) {
+    std::ifstream exported_file(host_dir / path, std::ios::binary);
+    ASSERT_TRUE(exported_file.is_open()) << path;
+    std::string const exported_file_content((std::istreambuf_iterator<char>(exported_file)),
+                                            std::istreambuf_iterator<char>());
+
+    std::ostringstream oss;
+    file_system_.cat(std::string("samples/") + path, oss);
+    EXPECT_EQ(exported_file_content, oss.str()) << path;
+  }
+  EXPECT_TRUE(std::filesystem::is_directory(host_dir / "nested" / "empty"));
+  std::filesystem::remove_all(host_dir);
+}
+
+TEST_F(ExportTest, ExportDirectoryTreeErrors) {
+  std::filesystem::create_directory("exported_tree");
+  EXPECT_THROW(file_system_.export_dir("samples", "exported_tree"), std::invalid_argument);
+  std::filesystem::remove_all("exported_tree");
+
+  EXPECT_THROW(file_system_.export_dir("samples/short.txt", "exported_tree"), std::invalid_argument);
+  EXPECT_THROW(file_system_.export_dir("missing", "exported_tree"), std::invalid_argument);
+  EXPECT_FALSE(std::filesystem::exists("exported_tree"));
+}
+
+TEST_F(ExportTest, ExportToHost) {
+  // interleaved appends leave both files fragmented, each run is copied separately
+  file_system_.touch("a.txt");
+  file_system_.touch("b.txt");
+  std::string expected;
+  for (int i = 0; i < 8; ++i) {
+    auto chunk = std::string(static_cast<std::size_t>(CLUSTER_SIZE), static_cast<char>('a' + i));
+    expected += chunk;
+    file_system_.write_file("a.txt", Converter::to_bytes(expected));
+    file_system_.write_file("b.txt", Converter::to_bytes(expected));
+  }
+
+  file_system_.export_to_host("a.txt", "exported_a.txt");
+  file_system_.export_to_host("samples/long.txt", "exported_long.txt");
+
+  std::ifstream exported_a("exported_a.txt", std::ios::binary);
+  EXPECT_EQ(std::string((std::istreambuf_iterator<char>(exported_a)), std::istreambuf_iterator<char>()), expected);
+
+  std::ifstream exported_long("exported_long.txt", std::ios::binary);
+  std::ostringstream oss;
+  file_system_.cat("samples/long.txt", oss);
+  EXPECT_EQ(std::string((std::istreambuf_iterator<char>(exported_long)), std::istreambuf_iterator<char>()), oss.str());
+
+  EXPECT_THROW(file_system_.export_to_host("samples", "exported_dir.txt"), std::invalid_argument);
+  EXPECT_THROW(file_system_.export_to_host("missing", "exported_missing.txt"), std::invalid_argument);
+  std::filesystem::remove("exported_a.txt");
+  std::filesystem::remove("exported_long.txt");
+}
@@ -65,4 +65,84 @@ TEST_F(FATTest, AllocateTooMany) {
 TEST_F(FATTest, EmptyEntryBytes) {
   auto const empty_entry_bytes = FAT::get_empty_entry_bytes();
   EXPECT_EQ(empty_entry_bytes.size(), FAT::get_entry_size());
-}
\ No newline at end of file
+}
+
+TEST_F(FATTest, AllocateChainContiguous) {
+  auto const chain = fat_.allocate_chain(4);
+  ASSERT_EQ(chain.size(), 4);
+  for (std::uint64_t i = 0; i + 1 < chain.size(); ++i) {
+    EXPECT_EQ(chain[i + 1], chain[i] + 1);
+    EXPECT_EQ(fat_.get_next(chain[i]), chain[i + 1]);
+  }
+  EXPECT_TRUE(fat_.is_last(chain.back()));
+}
+
+TEST_F(FATTest, AllocateChainSkipsShortGaps) {
+  auto const first = fat_.allocate();
+  auto const gap = fat_.allocate();
+  auto const second = fat_.allocate();
+  fat_.free(gap);
+
+  auto const chain = fat_.allocate_chain(3);
+  EXPECT_EQ(chain, (std::vector<std::uint64_t>{second + 1, second + 2, second + 3}));
+  EXPECT_FALSE(fat_.is_allocated(gap));
+  EXPECT_TRUE(fat_.is_allocated(first));
+}
+
+TEST_F(FATTest, AllocateChainFragmented) {
+  std::vector<std::uint64_t> clusters;
+  for (std::uint64_t i = 0; i < fat_.get_clusters_count(); ++i) clusters.push_back(fat_.allocate());
+  fat_.free(clusters[1]);
+  fat_.free(clusters[3]);
+
+  auto const chain = fat_.allocate_chain(2);
+  EXPECT_EQ(chain, (std::vector<std::uint64_t>{clusters[1], clusters[3]}));
+  EXPECT_EQ(fat_.get_next(chain[0]), chain[1]);
+  EXPECT_TRUE(fat_.is_last(chain[1]));
+}
+
+TEST_F(FATTest, GetChainFollowsFragmentedChain) {
+  std::vector<std::uint64_t> clusters;
+  for (std::uint64_t i = 0; i < fat_.get_clusters_count(); ++i) clusters.push_back(fat_.allocate());
+  fat_.free(clusters[1]);
+  fat_.free(clusters[3]);
+  fat_.free(clusters[4]);
+
+  auto const chain = fat_.allocate_chain(3);
+  EXPECT_EQ(fat_.get_chain(chain[0], 3), chain);
+  EXPECT_EQ(fat_.get_chain(chain[0], 2), (std::vector<std::uint64_t>{chain[0], chain[1]}));
+  EXPECT_THROW(auto longer = fat_.get_chain(chain[0], 4), std::runtime_error);
+}
+
+TEST_F(FATTest, AllocateChainTooLong) {
+  EXPECT_THROW(auto chain = fat_.allocate_chain(fat_.get_clusters_count() + 1), std::runtime_error);
+}
+
+TEST_F(FATTest, SharedChainIsFreedByLastOwner) {
+  auto const chain = fat_.allocate_chain(3);
+  fat_.share(chain[1]);
+  EXPECT_TRUE(fat_.is_shared(chain[1]));
+  EXPECT_EQ(fat_.get_references_count(chain[1]), 2);
+
+  fat_.free(chain[0]);
+  EXPECT_FALSE(fat_.is_allocated(chain[0]));
+  EXPECT_TRUE(fat_.is_allocated(chain[1]));
+  EXPECT_TRUE(fat_.is_allocated(chain[2]));
+  EXPECT_FALSE(fat_.is_shared(chain[1]));
+
+  fat_.free(chain[1]);
+  EXPECT_FALSE(fat_.is_allocated(chain[1]));
+  EXPECT_FALSE(fat_.is_allocated(chain[2]));
+}
+
+TEST_F(FATTest, OlderLayoutIsRefused) {
+  {
+    std::fstream image(PATH, std::ios::binary | std::ios::in | std::ios::out);
+    image.write(FSMaker::get_legacy_signature().data(), static_cast<std::streamsize>(FSMaker::get_signature_size()));
+  }
+
+  try {
+    FileSystem const file_system(PATH);
+    FAIL() << "an image of the older layout was opened";
+  } catch (std::runtime_error const &e) { EXPECT_NE(std::string(e.what()).find("older layout"), std::string::npos); }
+}
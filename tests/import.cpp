@@ -1,6 +1,7 @@
 #include "../src/FileSystem/FileSystem.hpp"
 #include <filesystem>
 #include <gtest/gtest.h>
+#include <map>
 
 class ImportTest : public testing::Test {
 protected:
@@ -107,4 +108,126 @@ TEST_F(ImportTest, ImportLongRealFile) {
 
   EXPECT_EQ(host_fs_file_content, oss.str());
   host_fs_file.close();
-}
\ No newline at end of file
+}
+
+TEST_F(ImportTest, ImportDirectoryTree) {
+  std::filesystem::path const host_dir = "import_tree";
+  std::filesystem::create_directories(host_dir / "docs" / "empty");
+  std::map<std::string, std::string> const files = {
+      {"top.txt", "top level"},
+      {"docs/long.txt", std::string(1000, 'l')},
+      {"docs/short.txt", "short"},
+      {"empty.txt", ""},
+  };
+  for (auto const &[path, content] : files) std::ofstream(host_dir / path, std::ios::binary) << content;
+
+  file_system_.mkdir("/dir");
+  std::size_t const threads = 3;
+  file_system_.import_dir(host_dir.string(), "/dir/tree", threads);
+  std::filesystem::remove_all(host_dir);
+
+  for (auto const &[path, content] : files) {
+    std::ostringstream oss;
+    file_system_.cat("/dir/tree/" + path, oss);
+    EXPECT_EQ(oss.str(), content) << path;
+  }
+
+  std::vector<std::string> names;
+  for (auto const &meta : file_system_.ls("/dir/tree/docs")) names.push_back(meta.get_name());
+  EXPECT_EQ(names, (std::vector<std::string>{"empty", "long.txt", "short.txt"}));
+  EXPECT_TRUE(file_system_.stat("/dir/tree/docs/empty").is_directory());
+  EXPECT_TRUE(file_system_.ls("/dir/tree/docs/empty").empty());
+}
+
+TEST_F(ImportTest, ImportDirectoryErrors) {
+  std::filesystem::create_directories("import_tree");
+  file_system_.mkdir("/taken");
+
+  EXPECT_THROW(file_system_.import_dir("import_tree", "/taken"), std::invalid_argument);
+  EXPECT_THROW(file_system_.import_dir("import_tree", "/missing/tree"), std::invalid_argument);
+  EXPECT_THROW(file_system_.import_dir("no_such_host_dir", "/tree"), std::invalid_argument);
+  std::filesystem::remove_all("import_tree");
+}
+
+TEST_F(ImportTest, FailedDirectoryImportReleasesClusters) {
+  std::filesystem::path const host_dir = "import_tree";
+  std::filesystem::create_directories(host_dir / "a_nested");
+  std::ofstream(host_dir / "a_nested" / "file.txt", std::ios::binary) << std::string(1000, 'f');
+  std::ofstream(host_dir / "b_first.txt", std::ios::binary) << std::string(500, 'b');
+  std::ofstream(host_dir / std::string(120, 'z'), std::ios::binary) << "name too long";
+
+  auto const allocated = file_system_.get_allocated_clusters_count();
+  EXPECT_THROW(file_system_.import_dir(host_dir.string(), "/tree"), std::invalid_argument);
+  std::filesystem::remove_all(host_dir);
+
+  EXPECT_THROW(static_cast<void>(file_system_.stat("/tree")), std::invalid_argument);
+  EXPECT_EQ(file_system_.get_allocated_clusters_count(), allocated);
+}
+
+TEST_F(ImportTest, ImportDirectoryWithLargeFile) {
+  // a file spanning several import blocks is streamed through the pipeline a block at a time
+  std::filesystem::path const host_dir = "import_tree";
+  std::filesystem::create_directories(host_dir);
+  std::string content;
+  for (int i = 0; i < 600000; ++i) content += static_cast<char>('a' + i % 26);
+  std::ofstream(host_dir / "large.bin", std::ios::binary) << content;
+  std::ofstream(host_dir / "small.txt", std::ios::binary) << "small";
+
+  std::string const large_path = "large_test.fs";
+  FileSystem::make(large_path, {2097152, 512});
+  {
+    FileSystem large_file_system(large_path);
+    std::size_t const threads = 2;
+    large_file_system.import_dir(host_dir.string(), "/tree", threads);
+    EXPECT_EQ(Converter::to_string(large_file_system.read_file("/tree/large.bin")), content);
+    EXPECT_EQ(Converter::to_string(large_file_system.read_file("/tree/small.txt")), "small");
+  }
+  std::filesystem::remove_all(host_dir);
+  std::filesystem::remove(large_path);
+}
+
+TEST_F(ImportTest, ImportFromHost) {
+  std::string content;
+  for (int i = 0; i < 3000; ++i) content += static_cast<char>('a' + i % 26);
+  {
+    std::ofstream file("host.bin", std::ios::binary);
+    file << content;
+  }
+
+  file_system_.mkdir("/dir");
+  file_system_.import_from_host("host.bin", "/dir/file.bin");
+  EXPECT_EQ(file_system_.stat("/dir/file.bin").get_size(), content.size());
+  EXPECT_EQ(Converter::to_string(file_system_.read_file("/dir/file.bin")), content);
+
+  // reopening reads the kernel-copied clusters back from the image
+  file_system_.sync();
+  FileSystem reopened(PATH);
+  EXPECT_EQ(Converter::to_string(reopened.read_file("/dir/file.bin")), content);
+
+  EXPECT_THROW(file_system_.import_from_host("host.bin", "/dir/file.bin"), std::invalid_argument);
+  EXPECT_THROW(file_system_.import_from_host("host.bin", "/missing/file.bin"), std::invalid_argument);
+  EXPECT_THROW(file_system_.import_from_host("no_such_host_file", "/dir/other.bin"), std::runtime_error);
+  std::filesystem::remove("host.bin");
+}
+
+TEST_F(ImportTest, FailedImportFromHostReleasesClusters) {
+  {
+    std::ofstream file("host.bin", std::ios::binary);
+    file << std::string(2 * SIZE, 'x');
+  }
+  std::filesystem::create_directory("host_dir");
+
+  auto const allocated = file_system_.get_allocated_clusters_count();
+  EXPECT_ANY_THROW(file_system_.import_from_host("host.bin", "/large.bin"));
+  EXPECT_THROW(static_cast<void>(file_system_.stat("/large.bin")), std::invalid_argument);
+  EXPECT_EQ(file_system_.get_allocated_clusters_count(), allocated);
+
+  // a directory opens as a host file with a size, but reading its data fails once the chain is in place
+  if (std::filesystem::status("host_dir").type() == std::filesystem::file_type::directory) {
+    EXPECT_ANY_THROW(file_system_.import_from_host("host_dir", "/dir.bin"));
+    EXPECT_THROW(static_cast<void>(file_system_.stat("/dir.bin")), std::invalid_argument);
+    EXPECT_EQ(file_system_.get_allocated_clusters_count(), allocated);
+  }
+  std::filesystem::remove("host.bin");
+  std::filesystem::remove("host_dir");
+}
@@ -0,0 +1,95 @@
+#include "../src/FileSystem/FileSystem.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <sstream>
+
+class IOStatsTest : public testing::Test {
+protected:
+  // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+  std::string const PATH = "test.fs";
+  std::uint64_t const SIZE = 65536;
+  std::uint64_t const CLUSTER_SIZE = 256;
+
+  FileSystem file_system_;
+  // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+  auto SetUp() -> void override {
+    FileSystem::make(PATH, {SIZE, CLUSTER_SIZE});
+    file_system_ = FileSystem(PATH);
+    file_system_.sync();
+    file_system_.reset_io_stats();
+  }
+
+  auto TearDown() -> void override { std::filesystem::remove(PATH); }
+};
+
+TEST_F(IOStatsTest, ResetClearsCounters) {
+  file_system_.touch("file");
+  EXPECT_GT(file_system_.io_stats().total().writes, 0);
+
+  file_system_.reset_io_stats();
+  auto total = file_system_.io_stats().total();
+  EXPECT_EQ(total.reads, 0);
+  EXPECT_EQ(total.writes, 0);
+  EXPECT_EQ(total.seeks, 0);
+  EXPECT_EQ(file_system_.io_stats().flushes, 0);
+}
+
+TEST_F(IOStatsTest, TouchStaysWithinBounds) {
+  file_system_.mkdir("dir");
+  for (int i = 0; i < 16; ++i) file_system_.touch("dir/file" + std::to_string(i));
+  file_system_.reset_io_stats();
+
+  file_system_.touch("dir/another");
+
+  auto stats = file_system_.io_stats();
+  EXPECT_EQ(stats.superblock.reads + stats.superblock.writes, 0);
+  EXPECT_GT(stats.fat.writes, 0);
+  EXPECT_GT(stats.data.writes, 0);
+  EXPECT_LE(stats.total().writes, 4);
+  EXPECT_LE(stats.total().reads, 80);
+}
+
+TEST_F(IOStatsTest, LsOnlyReads) {
+  file_system_.mkdir("dir");
+  for (int i = 0; i < 16; ++i) file_system_.touch("dir/file" + std::to_string(i));
+  file_system_.reset_io_stats();
+
+  ASSERT_EQ(file_system_.ls("dir").size(), 16);
+
+  auto total = file_system_.io_stats().total();
+  EXPECT_EQ(total.writes, 0);
+  EXPECT_LE(total.reads, 56);
+}
+
+TEST_F(IOStatsTest, StatOnlyReads) {
+  file_system_.mkdir("dir");
+  for (int i = 0; i < 16; ++i) file_system_.touch("dir/file" + std::to_string(i));
+  file_system_.reset_io_stats();
+
+  static_cast<void>(file_system_.stat("dir/file7"));
+
+  auto total = file_system_.io_stats().total();
+  EXPECT_EQ(total.writes, 0);
+  EXPECT_LE(total.reads, 40);
+}
+
+TEST_F(IOStatsTest, SyncCountsFlushes) {
+  file_system_.touch("file");
+  file_system_.write_file("file", std::vector<std::byte>(1000, std::byte{1}));
+  file_system_.sync();
+
+  auto flushes = file_system_.io_stats().flushes;
+  EXPECT_GE(flushes, 1);
+  file_system_.sync(); // nothing left to write
+  EXPECT_EQ(file_system_.io_stats().flushes, flushes);
+}
+
+TEST_F(IOStatsTest, PrintedWithFileSystemInfo) {
+  file_system_.touch("file");
+
+  std::stringstream info;
+  info << file_system_;
+  EXPECT_NE(info.str().find("I/O:"), std::string::npos);
+  EXPECT_NE(info.str().find("Flushes:"), std::string::npos);
+}
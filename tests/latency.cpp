@@ -0,0 +1,69 @@
+#include "../src/FileSystem/FileSystem.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(LatencyHistogramTest, PercentilesStayWithinBucketError) {
+  LatencyHistogram histogram;
+  for (std::int64_t i = 1; i <= 1000; ++i) histogram.record(std::chrono::microseconds(i));
+
+  auto summary = histogram.summary();
+  EXPECT_EQ(summary.count, 1000);
+  EXPECT_GE(summary.p50, std::chrono::microseconds(500));
+  EXPECT_LE(summary.p50, std::chrono::microseconds(500) * 1.125);
+  EXPECT_GE(summary.p99, std::chrono::microseconds(990));
+  EXPECT_LE(summary.p99, std::chrono::microseconds(990) * 1.125);
+  EXPECT_EQ(summary.max, std::chrono::microseconds(1000));
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+  LatencyHistogram histogram;
+  for (std::int64_t i = 0; i < 8; ++i) histogram.record(std::chrono::nanoseconds(i));
+  EXPECT_EQ(histogram.percentile(0.5), std::chrono::nanoseconds(3));
+  EXPECT_EQ(histogram.percentile(1.0), std::chrono::nanoseconds(7));
+}
+
+TEST(LatencyHistogramTest, EmptyAndReset) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.summary().p99, std::chrono::nanoseconds(0));
+
+  histogram.record(std::chrono::milliseconds(3));
+  { LatencyHistogram::Timer timer(histogram); }
+  EXPECT_EQ(histogram.get_count(), 2);
+
+  histogram.reset();
+  EXPECT_EQ(histogram.get_count(), 0);
+  EXPECT_EQ(histogram.summary().max, std::chrono::nanoseconds(0));
+}
+
+TEST(LatencyHistogramTest, DumpListsNonEmptyBuckets) {
+  LatencyHistogram histogram;
+  histogram.record(std::chrono::nanoseconds(5));
+  histogram.record(std::chrono::nanoseconds(5));
+  histogram.record(std::chrono::nanoseconds(1000));
+
+  std::stringstream dump;
+  histogram.dump("ls", dump);
+  EXPECT_EQ(dump.str(), "ls,5,5,2\nls,960,1023,1\n");
+}
+
+TEST(LatencyHistogramTest, FileSystemRecordsPhases) {
+  std::string const path = "test.fs";
+  FileSystem::make(path, {8192, 128});
+  FileSystem file_system(path);
+  file_system.mkdir("dir");
+  file_system.touch("dir/file");
+  file_system.write_file("dir/file", Converter::to_bytes(std::string("data")));
+  file_system.reset_phase_latencies();
+
+  static_cast<void>(file_system.ls("dir"));
+  static_cast<void>(file_system.read_file("dir/file"));
+
+  auto const &phases = file_system.get_phase_latencies();
+  EXPECT_GE(phases.resolve.get_count(), 2);
+  EXPECT_GE(phases.metadata.get_count(), 1);
+  EXPECT_EQ(phases.data.get_count(), 1);
+
+  file_system.drain();
+  std::filesystem::remove(path);
+}
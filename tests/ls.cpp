@@ -60,4 +60,72 @@ TEST_F(LsTest, MultipleFilesNestedEmpty) {
 
   auto const list = file_system_.ls("/dir1/dir3");
   EXPECT_EQ(list.size(), 0);
-}
\ No newline at end of file
+}
+
+TEST_F(LsTest, Readdir) {
+  file_system_.mkdir("/dir1");
+  file_system_.touch("/file1");
+  file_system_.touch("/file2");
+
+  auto cursor = file_system_.readdir("/", true, 2);
+  EXPECT_EQ(cursor.get_count(), 3);
+
+  auto chunk = cursor.next();
+  ASSERT_EQ(chunk.size(), 2);
+  EXPECT_EQ(chunk[0].name, "dir1");
+  EXPECT_TRUE(chunk[0].is_directory);
+  EXPECT_FALSE(chunk[0].metadata.has_value());
+  EXPECT_EQ(chunk[1].name, "file1");
+  EXPECT_FALSE(chunk[1].is_directory);
+
+  chunk = cursor.next();
+  ASSERT_EQ(chunk.size(), 1);
+  EXPECT_EQ(chunk[0].name, "file2");
+  EXPECT_TRUE(cursor.is_done());
+  EXPECT_TRUE(cursor.next().empty());
+
+  auto full_cursor = file_system_.readdir("/");
+  auto entries = full_cursor.next();
+  ASSERT_EQ(entries.size(), 3);
+  ASSERT_TRUE(entries[2].metadata.has_value());
+  EXPECT_EQ(entries[2].metadata->get_first_cluster(), entries[2].cluster);
+
+  EXPECT_THROW(static_cast<void>(file_system_.readdir("/file1")), std::invalid_argument);
+  EXPECT_THROW(static_cast<void>(file_system_.readdir("/missing")), std::invalid_argument);
+}
+
+TEST_F(LsTest, ReaddirSkipsMovedEntries) {
+  file_system_.mkdir("/dir1");
+  file_system_.touch("/file1");
+  file_system_.touch("/file2");
+
+  auto cursor = file_system_.readdir("/", true, 1);
+  EXPECT_EQ(cursor.next()[0].name, "dir1");
+  file_system_.mv("/file1", "/dir1/file1");
+
+  auto chunk = cursor.next();
+  ASSERT_EQ(chunk.size(), 1);
+  EXPECT_EQ(chunk[0].name, "file2");
+  EXPECT_TRUE(cursor.next().empty());
+}
+
+TEST_F(LsTest, ReaddirSkipsRemovedEntries) {
+  file_system_.mkdir("/dir1");
+  file_system_.touch("/file1");
+  file_system_.touch("/file2");
+
+  auto cursor = file_system_.readdir("/", false, 1);
+  EXPECT_EQ(cursor.next()[0].name, "dir1");
+  file_system_.rm("/file1");
+
+  auto chunk = cursor.next();
+  ASSERT_EQ(chunk.size(), 1);
+  EXPECT_EQ(chunk[0].name, "file2");
+  EXPECT_TRUE(cursor.next().empty());
+
+  file_system_.touch("/dir1/inner");
+  auto removed_dir_cursor = file_system_.readdir("/dir1", false, 1);
+  EXPECT_EQ(removed_dir_cursor.get_count(), 1);
+  file_system_.rm("/dir1", true);
+  EXPECT_TRUE(removed_dir_cursor.next().empty());
+}
@@ -121,4 +121,43 @@ TEST_F(MvTest, MoveNonExistingFile) {
 
 TEST_F(MvTest, MoveFileToNonExistingDirectory) {
   EXPECT_THROW(file_system_.mv("samples/short.txt", "non_existing/short.txt"), std::invalid_argument);
-}
\ No newline at end of file
+}
+
+TEST_F(MvTest, RenameFileInPlace) {
+  auto const cluster = file_system_.stat("samples/long.txt").get_first_cluster();
+  file_system_.mv("samples/long.txt", "samples/renamed.txt");
+
+  auto const meta = file_system_.stat("samples/renamed.txt");
+  EXPECT_EQ(meta.get_first_cluster(), cluster);
+  EXPECT_EQ(meta.get_name(), "renamed.txt");
+  EXPECT_THROW(auto res = file_system_.stat("samples/long.txt"), std::invalid_argument);
+}
+
+TEST_F(MvTest, MoveKeepsClusters) {
+  auto const cluster = file_system_.stat("samples").get_first_cluster();
+  file_system_.mkdir("dir");
+  file_system_.mv("samples", "dir/samples", true);
+
+  auto const meta = file_system_.stat("dir/samples");
+  EXPECT_EQ(meta.get_first_cluster(), cluster);
+  EXPECT_EQ(meta.get_parent_first_cluster(), file_system_.stat("dir").get_first_cluster());
+}
+
+TEST_F(MvTest, MoveDirectoryIntoItself) {
+  file_system_.mkdir("samples/nested");
+  EXPECT_THROW(file_system_.mv("samples", "samples/nested/samples", true), std::invalid_argument);
+  EXPECT_THROW(file_system_.mv("samples", "samples/samples", true), std::invalid_argument);
+}
+
+TEST_F(MvTest, MoveRoot) { EXPECT_THROW(file_system_.mv("/", "/dir", true), std::invalid_argument); }
+
+TEST_F(MvTest, MoveToExistingDestination) {
+  EXPECT_THROW(file_system_.mv("samples/short.txt", "samples/long.txt"), std::invalid_argument);
+}
+
+TEST_F(MvTest, MoveWorkingDirectory) {
+  file_system_.mkdir("dir");
+  file_system_.cd("samples");
+  file_system_.mv("/samples", "/dir/samples", true);
+  EXPECT_EQ(file_system_.pwd(), "/dir/samples");
+}
@@ -115,4 +115,71 @@ TEST_F(ReaderWriterTest, MultipleLines) {
   }
 
   EXPECT_EQ(Converter::to_string(data), std::string("1 Hello, World!\n2 Hello, World!\n3 Hello, World!\n"));
-}
\ No newline at end of file
+}
+
+TEST_F(ReaderWriterTest, SequentialReadsHitReadahead) {
+  auto writer = file_system_.get_writer("file");
+  std::string const data(800, 'r');
+  writer.write(Converter::to_bytes(data));
+
+  auto reader = file_system_.get_reader("file");
+  reader.set_block_size(CLUSTER_SIZE);
+
+  std::string read_data;
+  for (auto block = reader.read_next(); !block.empty(); block = reader.read_next()) {
+    read_data += Converter::to_string(block);
+  }
+
+  EXPECT_EQ(read_data, data);
+  auto const &stats = reader.get_readahead_stats();
+  EXPECT_GT(stats.hits, stats.misses);
+  EXPECT_GT(stats.prefetched_bytes, 0);
+  EXPECT_GT(reader.get_readahead_window(), CLUSTER_SIZE);
+}
+
+TEST_F(ReaderWriterTest, ReadaheadWindowGrowsAndCollapses) {
+  auto writer = file_system_.get_writer("file");
+  writer.write(Converter::to_bytes(std::string(800, 'w')));
+
+  auto reader = file_system_.get_reader("file");
+  std::uint64_t const block_size = 8;
+  reader.set_block_size(block_size);
+
+  static_cast<void>(reader.read_next());
+  auto const first_window = reader.get_readahead_window();
+  EXPECT_EQ(first_window, block_size * 4);
+
+  for (std::uint64_t i = 0; i < first_window / block_size; ++i) static_cast<void>(reader.read_next());
+  EXPECT_EQ(reader.get_readahead_window(), first_window * 2);
+
+  reader.set_offset(500);
+  static_cast<void>(reader.read_next());
+  EXPECT_EQ(reader.get_readahead_window(), 0);
+}
+
+TEST_F(ReaderWriterTest, ReadaheadDisabled) {
+  auto writer = file_system_.get_writer("file");
+  writer.write(Converter::to_bytes(std::string(500, 'd')));
+
+  auto reader = file_system_.get_reader("file");
+  reader.set_max_readahead(0);
+  reader.set_block_size(CLUSTER_SIZE);
+  while (!reader.read_next().empty()) {}
+
+  EXPECT_EQ(reader.get_readahead_stats().hits, 0);
+  EXPECT_EQ(reader.get_readahead_stats().prefetched_bytes, 0);
+}
+
+TEST_F(ReaderWriterTest, ReadaheadSeesAppends) {
+  auto writer = file_system_.get_writer("file");
+  writer.write_next(Converter::to_bytes(std::string("first ")));
+
+  auto reader = file_system_.get_reader("file");
+  reader.set_block_size(3);
+  EXPECT_EQ(Converter::to_string(reader.read_next()), "fir");
+
+  writer.write_next(Converter::to_bytes(std::string("second")));
+  std::string rest;
+  for (auto block = reader.read_next(); !block.empty(); block = reader.read_next()) rest += Converter::to_string(block);
+  EXPECT_EQ(rest, "st second");
+}
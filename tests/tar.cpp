@@ -0,0 +1,165 @@
+#include "../src/FileSystem/FileSystem.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <sstream>
+
+class TarTest : public testing::Test {
+protected:
+  // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+  std::string const PATH = "test.fs";
+  std::uint64_t const SIZE = 2 * 1024 * 1024;
+  std::uint64_t const CLUSTER_SIZE = 256;
+
+  FileSystem file_system_;
+  // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+  auto SetUp() -> void override {
+    FileSystem::make(PATH, {SIZE, CLUSTER_SIZE});
+    file_system_ = FileSystem(PATH);
+  }
+
+  auto TearDown() -> void override {
+    file_system_.drain();
+    std::filesystem::remove(PATH);
+  }
+
+  auto write(std::string const &path, std::string const &content) -> void {
+    file_system_.touch(path);
+    file_system_.write_file(path, Converter::to_bytes(content));
+  }
+
+  auto read(std::string const &path) -> std::string {
+    std::ostringstream oss;
+    file_system_.cat(path, oss);
+    return oss.str();
+  }
+};
+
+TEST_F(TarTest, HeaderRoundTrip) {
+  std::string const long_path = std::string(90, 'd') + "/" + std::string(60, 'e') + "/" + std::string(64, 'f');
+  for (Tar::Header const &header : {Tar::Header{"dir/file", 1234, Tar::TypeOptions::FILE},
+                                    Tar::Header{"dir", 0, Tar::TypeOptions::DIRECTORY},
+                                    Tar::Header{long_path, 7, Tar::TypeOptions::FILE}}) {
+    auto read_header = Tar::from_bytes(Tar::to_bytes(header));
+    EXPECT_EQ(read_header.path, header.path);
+    EXPECT_EQ(read_header.size, header.size);
+    EXPECT_EQ(read_header.type, header.type);
+  }
+
+  auto block = Tar::to_bytes({"file", 1, Tar::TypeOptions::FILE});
+  block[0] = 'g';
+  EXPECT_THROW(static_cast<void>(Tar::from_bytes(block)), std::invalid_argument);
+  EXPECT_THROW(static_cast<void>(Tar::to_bytes({std::string(300, 'x'), 0, Tar::TypeOptions::FILE})),
+               std::invalid_argument);
+}
+
+TEST_F(TarTest, ExportImportRoundTrip) {
+  std::string const big(300 * 1024, 'b'); // more than one streaming batch
+  file_system_.mkdir("/src");
+  file_system_.mkdir("/src/nested");
+  file_system_.mkdir("/src/nested/empty");
+  write("/src/small.txt", "small");
+  write("/src/nested/big.bin", big);
+  file_system_.touch("/src/nested/zero");
+
+  std::stringstream archive;
+  file_system_.export_tar("/src", archive);
+  EXPECT_EQ(archive.str().size() % Tar::BLOCK_SIZE, 0);
+
+  file_system_.rm("/src", true);
+  file_system_.import_tar(archive, "/copy");
+
+  EXPECT_EQ(read("/copy/small.txt"), "small");
+  EXPECT_EQ(read("/copy/nested/big.bin"), big);
+  EXPECT_EQ(read("/copy/nested/zero"), "");
+  EXPECT_TRUE(file_system_.stat("/copy/nested/empty").is_directory());
+  EXPECT_EQ(file_system_.ls("/copy").size(), 2);
+}
+
+TEST_F(TarTest, ImportCreatesMissingParents) {
+  std::stringstream archive;
+  Tar::write_header(archive, {"./a/b/file", 3, Tar::TypeOptions::FILE});
+  archive << "abc";
+  Tar::write_padding(archive, 3);
+  Tar::write_header(archive, {"a/link", 0, '2'});
+  Tar::write_header(archive, {"a/b", 0, Tar::TypeOptions::DIRECTORY});
+  Tar::write_end(archive);
+
+  file_system_.import_tar(archive, "/tree");
+
+  EXPECT_EQ(read("/tree/a/b/file"), "abc");
+  EXPECT_EQ(file_system_.ls("/tree/a").size(), 1);
+}
+
+TEST_F(TarTest, ImportRejectsBadArchives) {
+  auto import = [this](std::string const &content, std::string const &path) {
+    std::istringstream archive(content);
+    file_system_.import_tar(archive, path);
+  };
+  auto const allocated_clusters_count = file_system_.get_allocated_clusters_count();
+
+  std::stringstream escaping;
+  Tar::write_header(escaping, {"../file", 0, Tar::TypeOptions::FILE});
+  Tar::write_end(escaping);
+  EXPECT_THROW(import(escaping.str(), "/escaping"), std::invalid_argument);
+
+  std::stringstream duplicate;
+  Tar::write_header(duplicate, {"file", 0, Tar::TypeOptions::FILE});
+  Tar::write_header(duplicate, {"file", 0, Tar::TypeOptions::FILE});
+  Tar::write_end(duplicate);
+  EXPECT_THROW(import(duplicate.str(), "/duplicate"), std::invalid_argument);
+
+  std::stringstream truncated;
+  Tar::write_header(truncated, {"file", 1000, Tar::TypeOptions::FILE});
+  truncated << "short";
+  EXPECT_THROW(import(truncated.str(), "/truncated"), std::invalid_argument);
+
+  std::stringstream bad_pax;
+  Tar::write_header(bad_pax, {"file", 0, Tar::TypeOptions::FILE});
+  Tar::write_header(bad_pax, {"pax", 10, Tar::TypeOptions::PAX_HEADER});
+  bad_pax << "99 path=a\n";
+  Tar::write_padding(bad_pax, 10);
+  Tar::write_header(bad_pax, {"next", 0, Tar::TypeOptions::FILE});
+  Tar::write_end(bad_pax);
+  EXPECT_THROW(import(bad_pax.str(), "/bad_pax"), std::invalid_argument);
+  EXPECT_EQ(file_system_.get_allocated_clusters_count(), allocated_clusters_count);
+
+  file_system_.mkdir("/taken");
+  std::stringstream empty;
+  Tar::write_end(empty);
+  EXPECT_THROW(import(empty.str(), "/taken"), std::invalid_argument);
+}
+
+TEST_F(TarTest, ImportLongNames) {
+  std::string long_dir;
+  for (int i = 0; i < 20; ++i) long_dir += "directory" + std::to_string(i) + "/";
+  auto const gnu_path = long_dir + "gnu";
+  auto const pax_path = long_dir + "pax";
+
+  std::stringstream archive;
+  Tar::write_header(archive, {"././@LongLink", gnu_path.size() + 1, Tar::TypeOptions::LONG_NAME});
+  archive << gnu_path << '\0';
+  Tar::write_padding(archive, gnu_path.size() + 1);
+  Tar::write_header(archive, {"truncated", 3, Tar::TypeOptions::FILE});
+  archive << "gnu";
+  Tar::write_padding(archive, 3);
+
+  // the length of a pax record counts its own digits
+  auto const record = " path=" + pax_path + "\n";
+  auto length = record.size() + 1;
+  while (std::to_string(length).size() + record.size() != length) ++length;
+  auto const records = std::to_string(length) + record + "9 size=3\n";
+  Tar::write_header(archive, {"PaxHeaders/pax", records.size(), Tar::TypeOptions::PAX_HEADER});
+  archive << records;
+  Tar::write_padding(archive, records.size());
+  Tar::write_header(archive, {"truncated", 0, Tar::TypeOptions::FILE});
+  archive << "pax";
+  Tar::write_padding(archive, 3);
+  Tar::write_end(archive);
+
+  file_system_.import_tar(archive, "/long");
+
+  EXPECT_EQ(read("/long/" + gnu_path), "gnu");
+  EXPECT_EQ(read("/long/" + pax_path), "pax");
+  EXPECT_EQ(file_system_.ls("/long").size(), 1);
+}
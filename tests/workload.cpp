@@ -0,0 +1,114 @@
+#include "../src/CLI/Workload/Workload.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <sstream>
+
+class WorkloadTest : public testing::Test {
+protected:
+  // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+  std::string const PATH = "test.fs";
+  std::uint64_t const SIZE = 256 * 1024;
+  std::uint64_t const CLUSTER_SIZE = 256;
+
+  FileSystem file_system_;
+  // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+  auto SetUp() -> void override {
+    FileSystem::make(PATH, {SIZE, CLUSTER_SIZE});
+    file_system_ = FileSystem(PATH);
+  }
+
+  auto TearDown() -> void override {
+    file_system_.drain();
+    std::filesystem::remove(PATH);
+  }
+
+  static auto parse(std::string const &trace) -> std::vector<Workload::Operation> {
+    std::istringstream in_stream(trace);
+    return Workload::read(in_stream);
+  }
+};
+
+TEST_F(WorkloadTest, TraceRoundTrip) {
+  std::vector<Workload::Operation> const operations = {
+      {std::chrono::microseconds(0), std::chrono::nanoseconds(1500), "mkdir", {"/dir"}},
+      {std::chrono::microseconds(42), std::chrono::nanoseconds(700), "cp", {"-r", "/dir", "/copy"}},
+      {std::chrono::microseconds(99), std::chrono::nanoseconds(300), "pwd", {}},
+  };
+
+  std::stringstream stream;
+  stream << "# comment\n";
+  for (auto const &operation : operations) Workload::write(stream, operation);
+  auto const read_operations = Workload::read(stream);
+
+  ASSERT_EQ(read_operations.size(), operations.size());
+  for (std::size_t i = 0; i < operations.size(); ++i) {
+    EXPECT_EQ(read_operations[i].start, operations[i].start);
+    EXPECT_EQ(read_operations[i].duration, operations[i].duration);
+    EXPECT_EQ(read_operations[i].command, operations[i].command);
+    EXPECT_EQ(read_operations[i].args, operations[i].args);
+  }
+}
+
+TEST_F(WorkloadTest, MalformedTrace) { EXPECT_THROW(static_cast<void>(parse("12 mkdir\n")), std::invalid_argument); }
+
+TEST_F(WorkloadTest, ReplayBuildsTree) {
+  auto const operations = parse("0 0 mkdir /dir\n"
+                                "1 0 cd /dir\n"
+                                "2 0 touch file\n"
+                                "3 0 cp file /dir/copy\n"
+                                "4 0 mv /dir/copy /moved\n"
+                                "5 0 ls /\n");
+
+  Workload::Report report;
+  Workload::replay(file_system_, operations, report);
+
+  EXPECT_EQ(report.operations_count, operations.size());
+  EXPECT_EQ(report.failures_count, 0);
+  EXPECT_EQ(report.latency.get_count(), operations.size());
+  EXPECT_EQ(report.command_latencies.at("mkdir").get_count(), 1);
+  EXPECT_NO_THROW(static_cast<void>(file_system_.stat("/dir/file")));
+  EXPECT_NO_THROW(static_cast<void>(file_system_.stat("/moved")));
+}
+
+TEST_F(WorkloadTest, ReplayCountsFailures) {
+  auto const operations = parse("0 0 rmdir /missing\n"
+                                "1 0 mkdir /dir\n"
+                                "2 0 mkdir /dir\n"
+                                "3 0 frobnicate /dir\n");
+
+  Workload::Report report;
+  Workload::replay(file_system_, operations, report);
+
+  EXPECT_EQ(report.operations_count, 4);
+  EXPECT_EQ(report.failures_count, 3);
+}
+
+TEST_F(WorkloadTest, ApplyRejectsBadNumbers) {
+  file_system_.touch("/file");
+  for (auto const *line : {"0 0 head /file\n", "0 0 head -c -1 /file\n", "0 0 tail -c x /file\n",
+                           "0 0 cat --offset 1k /file\n"}) {
+    auto const operations = parse(line);
+    EXPECT_THROW(Workload::apply(file_system_, operations.front()), std::invalid_argument) << line;
+  }
+}
+
+TEST_F(WorkloadTest, ParallelReplayIsolatesThreads) {
+  auto const operations = parse("0 0 mkdir /dir\n"
+                                "1 0 touch /dir/file\n"
+                                "2 0 cd /\n"
+                                "3 0 rm -r dir\n"
+                                "4 0 mkdir /kept\n");
+
+  std::size_t const threads = 4;
+  Workload::Report report;
+  Workload::replay(file_system_, operations, report, threads);
+
+  EXPECT_EQ(report.operations_count, operations.size() * threads);
+  EXPECT_EQ(report.failures_count, 0);
+  for (std::size_t i = 0; i < threads; ++i) {
+    auto const root = "/replay" + std::to_string(i);
+    EXPECT_NO_THROW(static_cast<void>(file_system_.stat(root + "/kept")));
+    EXPECT_THROW(static_cast<void>(file_system_.stat(root + "/dir")), std::invalid_argument);
+  }
+}